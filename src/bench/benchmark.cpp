@@ -0,0 +1,58 @@
+// Copyright (c) Tamas Csala
+
+#include <cstdio>
+#include <fstream>
+
+#include "./benchmark.hpp"
+
+static std::vector<BenchmarkResult> results;
+static std::vector<BenchmarkValue> values;
+
+void ReportBenchmarkResult(const BenchmarkResult& result) {
+  printf("%-40s %10ld iterations %12.3f us/iteration %14.0f items/s\n",
+         result.name.c_str(), result.iterations,
+         result.seconds_per_iteration * 1e6, result.items_per_second);
+  results.push_back(result);
+}
+
+void RecordBenchmarkValue(const std::string& name, double value, const std::string& unit) {
+  values.push_back(BenchmarkValue{name, value, unit});
+}
+
+// The names are ascii paths, without quotes or control characters.
+bool WriteBenchmarkJson(const std::string& path) {
+  std::ofstream file{path, std::ios::trunc};
+  file.precision(9);
+  file << "{\n  \"benchmarks\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchmarkResult& result = results[i];
+    file << (i == 0 ? "\n" : ",\n")
+         << "    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+         << ", \"us_per_iteration\": " << result.seconds_per_iteration * 1e6
+         << ", \"items_per_second\": " << result.items_per_second << "}";
+  }
+  file << "\n  ],\n  \"values\": [";
+  for (size_t i = 0; i < values.size(); ++i) {
+    const BenchmarkValue& value = values[i];
+    file << (i == 0 ? "\n" : ",\n")
+         << "    {\"name\": \"" << value.name << "\", \"value\": " << value.value
+         << ", \"unit\": \"" << value.unit << "\"}";
+  }
+  file << "\n  ]\n}\n";
+  return file.good();
+}
+
+// The values have empty timing columns, the results an empty value and unit.
+bool WriteBenchmarkCsv(const std::string& path) {
+  std::ofstream file{path, std::ios::trunc};
+  file.precision(9);
+  file << "name,iterations,us_per_iteration,items_per_second,value,unit\n";
+  for (const BenchmarkResult& result : results) {
+    file << result.name << ',' << result.iterations << ',' << result.seconds_per_iteration * 1e6
+         << ',' << result.items_per_second << ",,\n";
+  }
+  for (const BenchmarkValue& value : values) {
+    file << value.name << ",,,," << value.value << ',' << value.unit << '\n';
+  }
+  return file.good();
+}
@@ -0,0 +1,57 @@
+// Copyright (c) Tamas Csala
+
+#ifndef BENCH_BENCHMARK_HPP_
+#define BENCH_BENCHMARK_HPP_
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+struct BenchmarkResult {
+  std::string name;
+  long iterations;
+  double seconds_per_iteration;
+  double items_per_second;
+};
+
+// A derived number of a group of cases (speedup, counts, equivalence checks).
+struct BenchmarkValue {
+  std::string name;
+  double value;
+  std::string unit;
+};
+
+// Prints the result, and keeps it for the machine readable outputs.
+void ReportBenchmarkResult(const BenchmarkResult& result);
+// Only kept for the machine readable outputs, the caller prints it.
+void RecordBenchmarkValue(const std::string& name, double value, const std::string& unit);
+
+// Everything reported so far, the --json and --csv outputs of pyromaze_bench.
+// Returns false if the file can't be written.
+bool WriteBenchmarkJson(const std::string& path);
+bool WriteBenchmarkCsv(const std::string& path);
+
+// Calls fn() until at least min_time seconds elapsed, fn() should return the
+// number of items (particles, robots, ...) it processed.
+template<typename Fn>
+BenchmarkResult RunBenchmark(const std::string& name, Fn fn, double min_time = 0.5) {
+  typedef std::chrono::steady_clock Clock;
+
+  fn(); // warm up
+
+  long iterations = 0;
+  double items = 0;
+  Clock::time_point start = Clock::now();
+  double elapsed = 0.0;
+  while (elapsed < min_time) {
+    items += fn();
+    iterations++;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  }
+
+  BenchmarkResult result{name, iterations, elapsed / iterations, items / elapsed};
+  ReportBenchmarkResult(result);
+  return result;
+}
+
+#endif
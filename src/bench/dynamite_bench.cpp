@@ -0,0 +1,67 @@
+// Copyright (c) Tamas Csala
+
+#include <string>
+#include <vector>
+
+#include "./benchmark.hpp"
+#include "simulation/detonation_queue.hpp"
+#include "simulation/dynamite_fuse.hpp"
+#include "simulation/game_rules.hpp"
+
+namespace {
+
+constexpr double kDt = 1.0 / 60.0;
+constexpr int kFrames = 60;
+
+struct BenchDynamite {
+  glm::dvec3 pos;
+  double spawn_time, time_to_explode;
+  glm::vec3 fire_pos;
+};
+
+// What GameWorld::UpdateDynamites does: kFrames frames of dynamite_count burning fuses.
+// The detonated dynamites are lit again, so the count stays the same. Returns
+// the number of dynamite updates.
+double UpdateDynamites(int dynamite_count, uint64_t seed) {
+  Random random{seed};
+  std::vector<BenchDynamite> dynamites(dynamite_count);
+  for (BenchDynamite& dynamite : dynamites) {
+    dynamite.pos = glm::dvec3{random.Rand01()*256-128, 0, random.Rand01()*256-128};
+    // Lit at different times, so some of them detonate during the frames
+    dynamite.spawn_time = -3.5 * random.Rand01();
+    dynamite.time_to_explode = GameRules::DynamiteTimeToExplode(random);
+  }
+
+  DetonationQueue detonations;
+  double current_time = 0.0;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    current_time += kDt;
+    detonations.Clear();
+    for (BenchDynamite& dynamite : dynamites) {
+      double current_phase = (current_time - dynamite.spawn_time) / dynamite.time_to_explode;
+      if (current_phase > 1) {
+        detonations.Push(dynamite.pos);
+        dynamite.spawn_time = current_time;
+        current_phase = 0;
+      }
+      dynamite.fire_pos = glm::vec3(dynamite.pos) + FusePosition(current_phase);
+    }
+  }
+  // Keeps the updates from being optimized out
+  volatile float sink = dynamites[0].fire_pos.y + detonations.size();
+  (void)sink;
+
+  return double(dynamite_count) * kFrames;
+}
+
+}
+
+// The items are dynamite updates
+void RunDynamiteBenchmarks() {
+  for (int dynamite_count : {100, 1000, 10000}) {
+    uint64_t seed = 0;
+    RunBenchmark("dynamites/update/" + std::to_string(dynamite_count), [&] {
+      return UpdateDynamites(dynamite_count, seed++);
+    });
+  }
+}
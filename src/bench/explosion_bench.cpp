@@ -0,0 +1,249 @@
+// Copyright (c) Tamas Csala
+
+#include <cstdio>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "./benchmark.hpp"
+#include "simulation/explosion_damage.hpp"
+#include "simulation/game_rules.hpp"
+#include "simulation/spatial_grid.hpp"
+
+namespace {
+
+// The labyrinth radius of SceneComplexity::kWtf
+constexpr int kWtfRadius = 64;
+constexpr int kExplosionCount = 256;
+// The frames of the half second that an explosion used to damage for
+constexpr int kLegacyDamageFrames = 30;
+
+// The resolution that the one-shot one replaced: an explosion re-tested and
+// removed the wall parts around it one by one, on every frame of its first
+// half second. Kept as the baseline of the comparison.
+void LegacyReactToExplosion(const LabyrinthCollision& collision, const glm::dvec3& exp_position,
+                            double exp_radius, LabyrinthGrid* grid, FlowField* flow_field) {
+  double query_radius = GameRules::ExplosionQueryRadius(exp_radius);
+  grid->ForEachJunctionInRadius(exp_position, query_radius, [&](int x, int z) {
+    glm::vec3 junction_pos = LabyrinthGrid::GetJunctionPos(x, z);
+    for (int i = 0; i < 4; ++i) {
+      glm::vec3 part_center = junction_pos + collision.GetWallPartCenter(i);
+      if (grid->HasWallPart(x, z, i) &&
+          GameRules::IsWallPartHit(exp_position, exp_radius, glm::dvec3(part_center))) {
+        grid->RemoveWallPart(x, z, i);
+        flow_field->OnWallPartRemoved(x, z, i);
+      }
+    }
+  });
+}
+
+void OneShotReactToExplosion(const LabyrinthCollision& collision, const glm::dvec3& exp_position,
+                             double exp_radius, LabyrinthGrid* grid, FlowField* flow_field,
+                             std::vector<WallPartHit>* hits) {
+  hits->clear();
+  Blast blast{exp_position};
+  blast.radius = exp_radius;
+  FindWallPartsHit(*grid, collision, blast, hits);
+  DestroyWallParts(*hits, grid, flow_field);
+}
+
+// Spread around the flow field's window, some of them overlap.
+std::vector<glm::dvec3> ExplosionPositions() {
+  Random random{7};
+  double extent = FlowField::kDefaultWindowRadius * kWallLength;
+  std::vector<glm::dvec3> positions;
+  for (int i = 0; i < kExplosionCount; ++i) {
+    positions.push_back(glm::dvec3{(2*random.Rand01() - 1) * extent, 0,
+                                   (2*random.Rand01() - 1) * extent});
+  }
+  return positions;
+}
+
+struct DemolishedLabyrinth {
+  std::unique_ptr<LabyrinthGrid> grid;
+  std::unique_ptr<FlowField> flow_field;
+
+  DemolishedLabyrinth() : grid{new LabyrinthGrid{kWtfRadius, RandomStreams{0}}}
+                        , flow_field{new FlowField{*grid}} {
+    flow_field->SetTarget(glm::dvec3{10, 0, 10});
+  }
+};
+
+// A field of dynamites, kChainSpacing apart, the first one sets off the rest.
+constexpr int kChainSide = 16;
+constexpr double kChainSpacing = 8.0;
+
+struct ChainResult {
+  int blasts = 0;
+  int wall_parts = 0;
+  int particles = 0;
+};
+
+// Resolves the chain frame by frame, the detonations of a frame are merged
+// into blasts if merge is true, otherwise each of them is a blast.
+ChainResult RunChain(const LabyrinthCollision& collision, bool merge) {
+  DemolishedLabyrinth labyrinth;
+  std::vector<glm::dvec3> dynamites;
+  for (int x = 0; x < kChainSide; ++x) {
+    for (int z = 0; z < kChainSide; ++z) {
+      dynamites.push_back(glm::dvec3{x * kChainSpacing, 0, z * kChainSpacing});
+    }
+  }
+
+  ChainResult result;
+  std::vector<WallPartHit> hits;
+  DetonationQueue queue;
+  queue.Push(dynamites.back());
+  dynamites.pop_back();
+  while (!queue.empty()) {
+    std::vector<Blast> blasts;
+    if (merge) {
+      blasts = queue.TakeBlasts();
+    } else {
+      for (Blast& merged : queue.TakeBlasts()) {
+        for (const glm::dvec3& center : merged.centers) {
+          blasts.push_back(Blast{center});
+        }
+      }
+    }
+
+    for (const Blast& blast : blasts) {
+      hits.clear();
+      FindWallPartsHit(*labyrinth.grid, collision, blast, &hits);
+      DestroyWallParts(hits, labyrinth.grid.get(), labyrinth.flow_field.get());
+      for (size_t i = 0; i < dynamites.size();) {
+        if (blast.HitsActor(dynamites[i])) {
+          queue.Push(dynamites[i]);
+          dynamites[i] = dynamites.back();
+          dynamites.pop_back();
+          continue;
+        }
+        ++i;
+      }
+      result.blasts++;
+      result.wall_parts += hits.size();
+      result.particles += blast.ParticleBudget();
+    }
+  }
+  return result;
+}
+
+// An actor that only counts the blasts that hit it, standing in for the
+// robots and dynamites of the GameWorld.
+struct CountingActor {
+  glm::dvec3 pos;
+  int hit_count = 0;
+
+  void ReactToExplosion(const Blast& blast) {
+    if (blast.HitsActor(pos)) {
+      hit_count++;
+    }
+  }
+};
+
+// The actors that GameWorld::ReactToExplosion finds for a blast, through the
+// grid, or by scanning all of them like the explosions used to scan the scene.
+int ScanActors(const SpatialGrid<CountingActor>& grid, const Blast& blast,
+               std::vector<CountingActor*>* found) {
+  found->clear();
+  grid.Query(blast.center, blast.QueryRadius(),
+             [&](CountingActor* actor) { found->push_back(actor); });
+  for (CountingActor* actor : *found) {
+    actor->ReactToExplosion(blast);
+  }
+  return found->size();
+}
+
+int ScanAllActors(std::vector<CountingActor>* actors, const Blast& blast) {
+  for (CountingActor& actor : *actors) {
+    actor.ReactToExplosion(blast);
+  }
+  return actors->size();
+}
+
+}
+
+// The explosions used to be resolved on every frame of their first half
+// second, now they are resolved once (tests/explosion_test checks that they
+// destroy the same things). Compares their cost, and the cost of a chain
+// reaction with and without merging the overlapping blasts.
+void RunExplosionBenchmarks() {
+  std::unique_ptr<LabyrinthCollision> collision;
+  try {
+    collision.reset(new LabyrinthCollision{});
+  } catch (const std::exception& e) {
+    std::printf("explosion: %s (should be run from the repository root)\n", e.what());
+    return;
+  }
+
+  const std::vector<glm::dvec3> positions = ExplosionPositions();
+  const double radius = GameRules::kExplosionRadius;
+  std::vector<WallPartHit> hits;
+
+  // A new labyrinth (outside of the measurement) when the explosions run out
+  std::unique_ptr<DemolishedLabyrinth> labyrinth;
+  size_t explosion = 0;
+  auto next_explosion = [&]() -> const glm::dvec3& {
+    if (explosion % positions.size() == 0) {
+      labyrinth.reset();
+      labyrinth.reset(new DemolishedLabyrinth{});
+    }
+    return positions[explosion++ % positions.size()];
+  };
+
+  RunBenchmark("explosion/resolve/legacy_per_frame", [&] {
+    const glm::dvec3& pos = next_explosion();
+    for (int frame = 0; frame < kLegacyDamageFrames; ++frame) {
+      LegacyReactToExplosion(*collision, pos, radius, labyrinth->grid.get(),
+                             labyrinth->flow_field.get());
+    }
+    return 1.0;
+  });
+
+  explosion = 0;
+  RunBenchmark("explosion/resolve/one_shot", [&] {
+    OneShotReactToExplosion(*collision, next_explosion(), radius, labyrinth->grid.get(),
+                            labyrinth->flow_field.get(), &hits);
+    return 1.0;
+  });
+
+  // A chain of kChainSide^2 dynamites, the items are the detonations
+  for (bool merge : {false, true}) {
+    ChainResult chain = RunChain(*collision, merge);
+    std::string name = merge ? "explosion/chain/merged" : "explosion/chain/unmerged";
+    std::printf("%s: %d blasts, %d wall parts, %d particles\n",
+                name.c_str(), chain.blasts, chain.wall_parts, chain.particles);
+    RecordBenchmarkValue(name + "/blasts", chain.blasts, "count");
+    RecordBenchmarkValue(name + "/wall_parts", chain.wall_parts, "count");
+    RecordBenchmarkValue(name + "/particles", chain.particles, "count");
+    RunBenchmark(name, [&] {
+      RunChain(*collision, merge);
+      return double(kChainSide * kChainSide);
+    });
+  }
+
+  // Finding what a blast hits among the actors, spread over the labyrinth.
+  // The items are blasts.
+  for (int actor_count : {1000, 10000}) {
+    SpatialGrid<CountingActor> grid{kWallLength};
+    std::vector<CountingActor> actors(actor_count);
+    Random random{1};
+    double extent = kWtfRadius * kWallLength;
+    for (CountingActor& actor : actors) {
+      actor.pos = glm::dvec3{(2*random.Rand01() - 1) * extent, 0, (2*random.Rand01() - 1) * extent};
+      grid.Insert(&actor, grid.GetCell(actor.pos));
+    }
+
+    std::vector<CountingActor*> found;
+    std::string count = std::to_string(actor_count);
+    RunBenchmark("explosion/scene_scan/all/" + count, [&] {
+      ScanAllActors(&actors, Blast{actors[random.RandInt(actor_count)].pos});
+      return 1.0;
+    });
+    RunBenchmark("explosion/scene_scan/grid/" + count, [&] {
+      ScanActors(grid, Blast{actors[random.RandInt(actor_count)].pos}, &found);
+      return 1.0;
+    });
+  }
+}
@@ -0,0 +1,76 @@
+// Copyright (c) Tamas Csala
+
+#include <memory>
+
+#include "./benchmark.hpp"
+#include "simulation/flow_field.hpp"
+
+namespace {
+
+// The labyrinth radius of SceneComplexity::kWtf
+constexpr int kWtfRadius = 64;
+
+// The rooms searched by a field with the default window
+double WindowRoomCount() {
+  int side = 2*FlowField::kDefaultWindowRadius + 1;
+  return side * side;
+}
+
+// The junctions around the window of a field targeting the origin
+constexpr int kWindowJunctionRadius = FlowField::kDefaultWindowRadius + 1;
+
+}
+
+void RunFlowFieldBenchmarks() {
+  LabyrinthGrid grid{kWtfRadius, RandomStreams{0}};
+
+  // The player moving back and forth between two rooms
+  FlowField field{grid};
+  bool flip = false;
+  RunBenchmark("flow_field/rebuild/wtf", [&] {
+    flip = !flip;
+    field.SetTarget(flip ? glm::dvec3{10, 0, 10} : glm::dvec3{30, 0, 10});
+    return WindowRoomCount();
+  });
+
+  // The worst case, where every room is reachable
+  LabyrinthGrid open_grid{kWtfRadius, RandomStreams{0}};
+  for (int x = -kWindowJunctionRadius; x <= kWindowJunctionRadius; ++x) {
+    for (int z = -kWindowJunctionRadius; z <= kWindowJunctionRadius; ++z) {
+      for (int i = 0; i < 4; ++i) {
+        open_grid.RemoveWallPart(x, z, i);
+      }
+    }
+  }
+  FlowField open_field{open_grid};
+  RunBenchmark("flow_field/rebuild/wtf_no_walls", [&] {
+    flip = !flip;
+    open_field.SetTarget(flip ? glm::dvec3{10, 0, 10} : glm::dvec3{30, 0, 10});
+    return WindowRoomCount();
+  });
+
+  // Destroying every wall part of a junction, in a field that is rebuilt
+  // (outside of the measurement) from time to time, when it runs out of walls
+  std::unique_ptr<LabyrinthGrid> demolished_grid;
+  std::unique_ptr<FlowField> demolished;
+  int junction = 0;
+  const int window_side = 2*kWindowJunctionRadius + 1;
+  const int junction_count = window_side * window_side;
+  RunBenchmark("flow_field/remove_wall_part/wtf", [&] {
+    if (junction % junction_count == 0) {
+      demolished.reset();
+      demolished_grid.reset(new LabyrinthGrid{kWtfRadius, RandomStreams{0}});
+      demolished.reset(new FlowField{*demolished_grid});
+      demolished->SetTarget(glm::dvec3{10, 0, 10});
+    }
+    int index = (junction++ * 7919) % junction_count;
+    int x = index / window_side - kWindowJunctionRadius;
+    int z = index % window_side - kWindowJunctionRadius;
+    for (int i = 0; i < 4; ++i) {
+      if (demolished_grid->RemoveWallPart(x, z, i)) {
+        demolished->OnWallPartRemoved(x, z, i);
+      }
+    }
+    return 4.0;
+  });
+}
@@ -0,0 +1,44 @@
+// Copyright (c) Tamas Csala
+
+#include <string>
+
+#include "./benchmark.hpp"
+#include "simulation/labyrinth_grid.hpp"
+#include "settings.hpp"
+
+namespace {
+
+// Generates the walls of every chunk of the labyrinth (with the border), as
+// if the player walked around all of it. Returns the number of junctions.
+double GenerateLabyrinth(int radius, uint64_t seed) {
+  LabyrinthGrid grid{radius, RandomStreams{seed}};
+  LabyrinthChunkCoord min = LabyrinthChunkCoord::FromJunction(-radius - 1, -radius - 1);
+  LabyrinthChunkCoord max = LabyrinthChunkCoord::FromJunction(radius + 1, radius + 1);
+  int parts = 0;
+  for (int x = min.x; x <= max.x; ++x) {
+    for (int z = min.z; z <= max.z; ++z) {
+      LabyrinthChunkCoord chunk{x, z};
+      LabyrinthChunkWalls walls =
+          LabyrinthGrid::GenerateChunkWalls(radius, grid.random(), chunk, nullptr);
+      parts += walls.Get(0, 0);
+    }
+  }
+  // Keeps the generation from being optimized out
+  volatile int sink = parts;
+  (void)sink;
+
+  double diameter = Settings::LabyrinthDiameter(radius);
+  return diameter * diameter;
+}
+
+}
+
+// The items are junctions
+void RunLabyrinthBenchmarks() {
+  for (Settings::SceneComplexity complexity : Settings::kSceneComplexities) {
+    int radius = Settings::LabyrinthRadius(complexity);
+    uint64_t seed = 0;
+    RunBenchmark(std::string("labyrinth/generate/") + Settings::SceneComplexityName(complexity),
+                 [&] { return GenerateLabyrinth(radius, seed++); });
+  }
+}
@@ -0,0 +1,86 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "./benchmark.hpp"
+
+void RunLabyrinthBenchmarks();
+void RunParticleBenchmarks();
+void RunFlowFieldBenchmarks();
+void RunRobotBenchmarks();
+void RunDynamiteBenchmarks();
+void RunMeshCacheBenchmarks();
+void RunExplosionBenchmarks();
+
+struct BenchmarkGroup {
+  const char* name;
+  void (*run)();
+};
+
+static const BenchmarkGroup kGroups[] = {
+  {"labyrinth", RunLabyrinthBenchmarks},
+  {"particles", RunParticleBenchmarks},
+  {"flow_field", RunFlowFieldBenchmarks},
+  {"robots", RunRobotBenchmarks},
+  {"dynamites", RunDynamiteBenchmarks},
+  {"mesh_cache", RunMeshCacheBenchmarks},
+  {"explosion", RunExplosionBenchmarks},
+};
+
+static void PrintUsage(const char* binary_name) {
+  std::fprintf(stderr,
+               "Usage: %s [options]\n"
+               "  --json <file>    write the results as JSON too\n"
+               "  --csv <file>     write the results as CSV too\n"
+               "  --group <name>   only run a group of cases (can be repeated):\n"
+               "                  ", binary_name);
+  for (const BenchmarkGroup& group : kGroups) {
+    std::fprintf(stderr, " %s", group.name);
+  }
+  std::fprintf(stderr, "\n");
+}
+
+static bool IsKnownGroup(const char* name) {
+  for (const BenchmarkGroup& group : kGroups) {
+    if (std::strcmp(group.name, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(const int argc, const char *argv[]) {
+  std::string json_path, csv_path;
+  std::vector<std::string> groups;
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0 && i+1 < argc) {
+      json_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--csv") == 0 && i+1 < argc) {
+      csv_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--group") == 0 && i+1 < argc && IsKnownGroup(argv[i+1])) {
+      groups.push_back(argv[++i]);
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  for (const BenchmarkGroup& group : kGroups) {
+    if (groups.empty() || std::find(groups.begin(), groups.end(), group.name) != groups.end()) {
+      group.run();
+    }
+  }
+
+  if (!json_path.empty() && !WriteBenchmarkJson(json_path)) {
+    std::fprintf(stderr, "Can't write %s\n", json_path.c_str());
+    return 1;
+  }
+  if (!csv_path.empty() && !WriteBenchmarkCsv(csv_path)) {
+    std::fprintf(stderr, "Can't write %s\n", csv_path.c_str());
+    return 1;
+  }
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Tamas Csala
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "./benchmark.hpp"
+#include "simulation/mesh_cache.hpp"
+
+namespace {
+
+// The meshes of the game, relative to the repository root
+const char* const kMeshes[] = {
+  "src/resource/wall/pillars.obj", "src/resource/wall/wall1.obj",
+  "src/resource/wall/wall2.obj", "src/resource/wall/wall3.obj",
+  "src/resource/wall/wall4.obj", "src/resource/wall/bigwall1.obj",
+  "src/resource/wall/bigwall2.obj", "src/resource/robot.obj",
+  "src/resource/dynamite.obj", "src/resource/ground.obj"
+};
+
+}
+
+// The startup cost of the meshes with a cold cache (the .obj files are
+// parsed) and with a warm one (the caches are mapped).
+void RunMeshCacheBenchmarks() {
+  size_t vertex_count = 0;
+  for (const char* path : kMeshes) {
+    try {
+      ObjMesh mesh = ParseObjMesh(path);
+      vertex_count += mesh.vertices.size();
+      if (!WriteMeshCache(path, mesh)) {
+        std::printf("mesh_cache: can't write the cache of %s\n", path);
+        return;
+      }
+    } catch (const std::exception& e) {
+      std::printf("mesh_cache: %s (should be run from the repository root)\n", e.what());
+      return;
+    }
+  }
+
+  RunBenchmark("mesh_cache/load/cold", [&] {
+    size_t vertices = 0;
+    for (const char* path : kMeshes) {
+      vertices += ParseObjMesh(path).vertices.size();
+    }
+    return double(vertices);
+  });
+
+  RunBenchmark("mesh_cache/load/warm", [&] {
+    size_t vertices = 0;
+    for (const char* path : kMeshes) {
+      std::unique_ptr<MappedMeshCache> cache = MappedMeshCache::Open(path);
+      vertices += cache ? cache->header().vertex_count : 0;
+    }
+    return double(vertices);
+  });
+
+  // What LabyrinthCollision needs
+  RunBenchmark("mesh_cache/collision_bounds/obj", [&] {
+    size_t count = 0;
+    for (int i = 0; i < 7; ++i) {
+      count += LoadObjObjectBounds(kMeshes[i]).size();
+    }
+    return double(count);
+  });
+
+  RunBenchmark("mesh_cache/collision_bounds/cache", [&] {
+    size_t count = 0;
+    for (int i = 0; i < 7; ++i) {
+      count += LoadMeshObjectBounds(kMeshes[i]).size();
+    }
+    return double(count);
+  });
+}
@@ -0,0 +1,222 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "./benchmark.hpp"
+#include "simulation/job_system.hpp"
+#include "simulation/particle_simulation.hpp"
+
+namespace {
+
+constexpr float kDt = 1.0f / 60.0f;
+
+// The array of structs implementation that ParticleSimulation replaced,
+// kept as the baseline of the comparison.
+class LegacyParticleSimulation {
+ public:
+  LegacyParticleSimulation(ParticleGen generator, int max_particles_at_once,
+                           int max_particle_per_sec, int max_particle_count = -1)
+      : generator_{generator}
+      , random_{1}
+      , max_particle_per_sec_{max_particle_per_sec}
+      , max_particle_count_{max_particle_count} {
+    particles_.resize(max_particles_at_once);
+  }
+
+  bool IsFinished() const { return finished_; }
+
+  // Returns the number of live particles after the update.
+  int Update(const glm::vec3& emitter_pos, float current_time, float dt) {
+    newParticlesToSpawn_ += dt * max_particle_per_sec_;
+
+    if (max_particle_count_ >= particles_generated_) {
+      bool is_particle_still_alive = false;
+      for (Particle& particle : particles_) {
+        if (particle.IsAlive(current_time)) {
+          is_particle_still_alive = true;
+        }
+      }
+      if (!is_particle_still_alive) {
+        finished_ = true;
+        return 0;
+      }
+    }
+
+    int updated = 0;
+    for (Particle& particle : particles_) {
+      if (particle.IsAlive(current_time)) {
+        particle.Update(dt);
+        updated++;
+      } else if (newParticlesToSpawn_ >= 1 &&
+                 (max_particle_count_ < 0 ||
+                  particles_generated_ < max_particle_count_)) {
+        particle = generator_(emitter_pos, current_time, random_);
+        --newParticlesToSpawn_;
+        particles_generated_++;
+        updated++;
+      }
+    }
+    return updated;
+  }
+
+  void SpawnBurst(const glm::vec3& emitter_pos, float current_time, int one_in) {
+    for (Particle& particle : particles_) {
+      if (!particle.IsAlive(current_time) && random_.RandInt(one_in) == 0 &&
+          particles_generated_ < max_particle_count_) {
+        particle = generator_(emitter_pos, current_time, random_);
+        particles_generated_++;
+      }
+    }
+  }
+
+ private:
+  ParticleGen generator_;
+  Random random_;
+  float newParticlesToSpawn_ = 0.0;
+  std::vector<Particle> particles_;
+  int particles_generated_ = 0;
+  int max_particle_per_sec_, max_particle_count_;
+  bool finished_ = false;
+};
+
+// Ten seconds of a burning fuse.
+double FireLegacy() {
+  LegacyParticleSimulation fire{FireParticle, 1000, 200};
+  double particles = 0;
+  for (float t = 0; t < 10.0f; t += kDt) {
+    particles += fire.Update(glm::vec3{}, t, kDt);
+  }
+  return particles;
+}
+
+double FireAnalytic() {
+  ParticleSimulation fire{FireParticle, Random{1}, 1000, 200};
+  double particles = 0;
+  for (float t = 0; t < 10.0f; t += kDt) {
+    fire.Update(glm::vec3{}, t, kDt);
+    particles += fire.alive_count();
+  }
+  return particles;
+}
+
+// A whole explosion, until its last particle dies.
+double ExplosionLegacy() {
+  LegacyParticleSimulation explosion{ExplosionParticle, 2800, 0, 3000};
+  double particles = 0;
+  for (float t = 0; !explosion.IsFinished(); t += kDt) {
+    explosion.SpawnBurst(glm::vec3{}, t, 8);
+    particles += explosion.Update(glm::vec3{}, t, kDt);
+  }
+  return particles;
+}
+
+double ExplosionAnalytic() {
+  ParticleSimulation explosion{ExplosionParticle, Random{1}, 2800, 0, 3000};
+  double particles = 0;
+  for (float t = 0; !explosion.IsFinished(); t += kDt) {
+    explosion.SpawnBurst(glm::vec3{}, t, 8);
+    explosion.Update(glm::vec3{}, t, kDt);
+    particles += explosion.alive_count();
+  }
+  return particles;
+}
+
+// Only the generators of the particles, the items are particles.
+constexpr int kGeneratedParticles = 10000;
+
+double GenerateParticles(ParticleGen generator, Random* random) {
+  glm::vec3 sum{};
+  for (int i = 0; i < kGeneratedParticles; ++i) {
+    Particle particle = generator(glm::vec3{}, i * kDt, *random);
+    sum += particle.pos;
+  }
+  // Keeps the generation from being optimized out
+  volatile float sink = sum.x + sum.y + sum.z;
+  (void)sink;
+  return kGeneratedParticles;
+}
+
+// The largest distance between the closed form position of the particles and
+// their per frame integration, which the analytic particles replaced.
+float MaxAnalyticError(ParticleGen generator, Random* random) {
+  float max_error = 0;
+  for (int i = 0; i < 1000; ++i) {
+    Particle particle = generator(glm::vec3{}, 0, *random);
+    ParticleRecord record{particle};
+    for (float t = 0; particle.IsAlive(t); t += kDt) {
+      max_error = std::max(max_error, glm::distance(particle.pos, record.GetPos(t)));
+      particle.Update(kDt);
+    }
+  }
+  return max_error;
+}
+
+// A dynamite chain: kChainLength explosions and fires burning at the same
+// time, updated once per frame in one slice per thread, as in
+// HeadlessSimulation::UpdateParticles.
+constexpr int kChainLength = 32;
+
+double ParticleChain(JobSystem* job_system) {
+  std::vector<std::unique_ptr<ParticleSimulation>> explosions, fires;
+  for (int i = 0; i < kChainLength; ++i) {
+    explosions.emplace_back(new ParticleSimulation{ExplosionParticle, Random{1, uint64_t(i)},
+                                                   2800, 0, 3000});
+    fires.emplace_back(new ParticleSimulation{FireParticle, Random{2, uint64_t(i)}, 1000, 200});
+  }
+
+  double particles = 0;
+  for (float t = 0; !explosions[0]->IsFinished(); t += kDt) {
+    job_system->ParallelFor(2 * kChainLength, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        if (i < size_t(kChainLength)) {
+          explosions[i]->SpawnBurst(glm::vec3{}, t, 8);
+          explosions[i]->Update(glm::vec3{}, t, kDt);
+        } else {
+          fires[i - kChainLength]->Update(glm::vec3{}, t, kDt);
+        }
+      }
+    });
+
+    for (int i = 0; i < kChainLength; ++i) {
+      particles += explosions[i]->alive_count() + fires[i]->alive_count();
+    }
+  }
+  return particles;
+}
+
+}
+
+void RunParticleBenchmarks() {
+  Random random{1};
+  RunBenchmark("particles/generate/fire", [&] { return GenerateParticles(FireParticle, &random); });
+  RunBenchmark("particles/generate/explosion", [&] {
+    return GenerateParticles(ExplosionParticle, &random);
+  });
+
+  RunBenchmark("particles/fire/legacy_aos", FireLegacy);
+  RunBenchmark("particles/fire/analytic", FireAnalytic);
+  RunBenchmark("particles/explosion/legacy_aos", ExplosionLegacy);
+  RunBenchmark("particles/explosion/analytic", ExplosionAnalytic);
+  float max_error = std::max(MaxAnalyticError(FireParticle, &random),
+                             MaxAnalyticError(ExplosionParticle, &random));
+  printf("%-40s %10.4f m\n", "particles/analytic/max_error", max_error);
+  RecordBenchmarkValue("particles/analytic/max_error", max_error, "m");
+
+  JobSystem single_thread{1};
+  BenchmarkResult serial = RunBenchmark("particles/chain/threads:1", [&] {
+    return ParticleChain(&single_thread);
+  });
+
+  JobSystem all_threads{std::thread::hardware_concurrency()};
+  std::string name = "particles/chain/threads:" + std::to_string(all_threads.thread_count());
+  BenchmarkResult parallel = RunBenchmark(name, [&] {
+    return ParticleChain(&all_threads);
+  });
+  double speedup = parallel.items_per_second / serial.items_per_second;
+  printf("%-40s %10.2fx\n", "particles/chain/speedup", speedup);
+  RecordBenchmarkValue("particles/chain/speedup", speedup, "x");
+}
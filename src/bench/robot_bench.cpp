@@ -0,0 +1,80 @@
+// Copyright (c) Tamas Csala
+
+#include <string>
+#include <vector>
+
+#include "./benchmark.hpp"
+#include "simulation/flow_field.hpp"
+#include "simulation/game_rules.hpp"
+#include "simulation/labyrinth_grid.hpp"
+#include "simulation/spatial_grid.hpp"
+
+namespace {
+
+constexpr double kDt = 1.0 / 60.0;
+constexpr int kFrames = 60;
+
+const glm::dvec3 kPlayerPos{10, 3, 10};
+
+struct BenchRobot {
+  glm::dvec3 pos;
+  GridCell cell;
+};
+
+// What RobotSwarm::Update does for the awake robots, with the rigid body replaced
+// by moving the robot with its velocity: kFrames frames of robot_count robots
+// that start at random positions of the activation range. Returns the number
+// of robot updates.
+double UpdateRobots(const FlowField& flow_field, int robot_count, uint64_t seed) {
+  SpatialGrid<BenchRobot> grid{kWallLength};
+  GridCell player_cell = grid.GetCell(kPlayerPos);
+  double range = (GameRules::kRobotActivationCellRadius + 0.5) * kWallLength;
+
+  Random random{seed};
+  std::vector<BenchRobot> robots(robot_count);
+  for (BenchRobot& robot : robots) {
+    robot.pos = glm::dvec3{kPlayerPos.x + (2*random.Rand01() - 1) * range, 0,
+                           kPlayerPos.z + (2*random.Rand01() - 1) * range};
+    robot.cell = grid.GetCell(robot.pos);
+    grid.Insert(&robot, robot.cell);
+  }
+
+  int asleep = 0;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (BenchRobot& robot : robots) {
+      GridCell cell = grid.GetCell(robot.pos);
+      grid.Move(&robot, robot.cell, cell);
+      robot.cell = cell;
+
+      glm::dvec3 velocity;
+      if (!GameRules::RobotChaseVelocity(robot.pos, kPlayerPos, flow_field, &velocity)) {
+        if (!GameRules::IsInRobotActivationRange(player_cell, robot.cell)) {
+          asleep++;
+        }
+        continue;
+      }
+      robot.pos += velocity * kDt;
+    }
+  }
+  // Keeps the updates from being optimized out
+  volatile int sink = asleep;
+  (void)sink;
+
+  return double(robot_count) * kFrames;
+}
+
+}
+
+// The items are robot updates
+void RunRobotBenchmarks() {
+  LabyrinthGrid labyrinth{16, RandomStreams{0}};
+  FlowField flow_field{labyrinth};
+  flow_field.SetTarget(kPlayerPos);
+
+  for (int robot_count : {100, 1000, 10000}) {
+    uint64_t seed = 0;
+    RunBenchmark("robots/update/" + std::to_string(robot_count), [&] {
+      return UpdateRobots(flow_field, robot_count, seed++);
+    });
+  }
+}
@@ -0,0 +1,136 @@
+// Copyright (c) Tamas Csala
+
+#include <iostream>
+#include <stdexcept>
+#include <lodepng.h>
+
+#include "./asset_manager.hpp"
+
+AssetManager::AssetManager(const std::vector<std::string>& preloaded_images) {
+  std::vector<std::pair<std::string, std::promise<RgbaImage>>> jobs;
+  for (const std::string& path : preloaded_images) {
+    if (texture_caches_.count(path) != 0 || images_.count(path) != 0) {
+      continue;
+    }
+    std::unique_ptr<MappedTextureCache> cache = MappedTextureCache::Open(path);
+    if (cache) {
+      texture_caches_[path] = std::move(cache);
+    } else {
+      std::promise<RgbaImage> promise;
+      images_[path] = promise.get_future().share();
+      jobs.emplace_back(path, std::move(promise));
+    }
+  }
+
+  // The map isn't touched by the thread, it only fulfils the promises
+  decoder_thread_ = std::thread([](std::vector<std::pair<std::string, std::promise<RgbaImage>>> jobs) {
+    for (auto& job : jobs) {
+      try {
+        job.second.set_value(Decode(job.first));
+      } catch (...) {
+        job.second.set_exception(std::current_exception());
+      }
+    }
+  }, std::move(jobs));
+}
+
+AssetManager::~AssetManager() {
+  decoder_thread_.join();
+}
+
+RgbaImage AssetManager::Decode(const std::string& path) {
+  RgbaImage image;
+  unsigned error = lodepng::decode(image.rgba, image.width, image.height, path, LCT_RGBA, 8);
+  if (error) {
+    std::cerr << "Image decoder error " << error << ": " << lodepng_error_text(error) << std::endl;
+    throw std::runtime_error("Image decoder error");
+  }
+  return image;
+}
+
+std::unique_ptr<MappedTextureCache> AssetManager::TakeTextureCache(const std::string& path) {
+  auto iter = texture_caches_.find(path);
+  if (iter == texture_caches_.end()) {
+    return MappedTextureCache::Open(path);
+  }
+  std::unique_ptr<MappedTextureCache> cache = std::move(iter->second);
+  texture_caches_.erase(iter);
+  return cache;
+}
+
+const RgbaImage& AssetManager::GetImage(const std::string& path) {
+  auto iter = images_.find(path);
+  if (iter == images_.end()) {
+    std::promise<RgbaImage> promise;
+    try {
+      promise.set_value(Decode(path));
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+    iter = images_.insert(std::make_pair(path, promise.get_future().share())).first;
+  }
+  return iter->second.get();
+}
+
+gl::Texture2D& AssetManager::GetTexture(const std::string& path) {
+  std::unique_ptr<gl::Texture2D>& texture = textures_[path];
+  if (texture) {
+    return *texture;
+  }
+
+  texture.reset(new gl::Texture2D{});
+  gl::Bind(*texture);
+  std::unique_ptr<MappedTextureCache> cache = TakeTextureCache(path);
+  if (cache && cache->header().face_count == 1) {
+    for (unsigned level = 0; level < cache->header().level_count; ++level) {
+      const TextureCacheLevel& entry = cache->level(0, level);
+      glTexImage2D(GL_TEXTURE_2D, level, GL_SRGB8_ALPHA8, entry.width, entry.height, 0,
+                   GL_RGBA, GL_UNSIGNED_BYTE, cache->texels(entry));
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, cache->header().level_count - 1);
+    texture->minFilter(gl::kLinearMipmapLinear);
+  } else {
+    const RgbaImage& image = GetImage(path);
+    texture->upload(gl::kSrgb8Alpha8, image.width, image.height,
+                    gl::kRgba, gl::kUnsignedByte, image.rgba.data());
+    texture->minFilter(gl::kLinear);
+  }
+  texture->magFilter(gl::kLinear);
+  gl::Unbind(*texture);
+
+  return *texture;
+}
+
+gl::TextureCube& AssetManager::GetCubeTexture(const std::string& path) {
+  std::unique_ptr<gl::TextureCube>& texture = cube_textures_[path];
+  if (texture) {
+    return *texture;
+  }
+
+  texture.reset(new gl::TextureCube{});
+  gl::Bind(*texture);
+  std::unique_ptr<MappedTextureCache> cache = TakeTextureCache(path);
+  if (cache && cache->header().face_count == 6) {
+    for (unsigned face = 0; face < 6; ++face) {
+      for (unsigned level = 0; level < cache->header().level_count; ++level) {
+        const TextureCacheLevel& entry = cache->level(face, level);
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, level, GL_SRGB8_ALPHA8,
+                     entry.width, entry.height, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                     cache->texels(entry));
+      }
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, cache->header().level_count - 1);
+    texture->minFilter(gl::kLinearMipmapLinear);
+  } else {
+    std::vector<RgbaImage> faces = SplitCubeCross(GetImage(path));
+    for (int i = 0; i < 6; ++i) {
+      texture->upload(texture->cubeFace(i), gl::kSrgb8Alpha8, faces[i].width, faces[i].height,
+                      gl::kRgba, gl::kUnsignedByte, faces[i].rgba.data());
+    }
+    texture->minFilter(gl::kLinear);
+  }
+  texture->magFilter(gl::kLinear);
+  gl::Unbind(*texture);
+
+  return *texture;
+}
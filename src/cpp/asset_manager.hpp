@@ -0,0 +1,55 @@
+// Copyright (c) Tamas Csala
+
+#ifndef ASSET_MANAGER_HPP_
+#define ASSET_MANAGER_HPP_
+
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Silice3D/common/oglwrap.hpp>
+
+#include "simulation/texture_cache.hpp"
+
+constexpr const char kSkyboxImage[] = "src/resource/skybox.png";
+constexpr const char kDiedScreenImage[] = "src/resource/died.png";
+constexpr const char kVictoryScreenImage[] = "src/resource/victory.png";
+constexpr const char kDynamiteImage[] = "src/resource/dynamite.png";
+
+// Decodes the images on a background thread, and caches the decoded images
+// and their textures by path, so neither happens again when a scene is
+// reloaded. The textures are uploaded from the texture cache of the image
+// instead if it's up to date (see simulation/texture_cache.hpp), those
+// aren't decoded at all. Must be destroyed before the OpenGL context.
+class AssetManager {
+ public:
+  // Maps the texture caches, and starts decoding the images without one.
+  explicit AssetManager(const std::vector<std::string>& preloaded_images);
+  ~AssetManager();
+
+  // Waits for the image if it's still being decoded, and decodes it on the
+  // calling thread if it wasn't preloaded. Throws on decoder errors.
+  const RgbaImage& GetImage(const std::string& path);
+
+  // Uploads the image on the first call.
+  gl::Texture2D& GetTexture(const std::string& path);
+
+  // The six faces of a horizontal cross layout, uploaded on the first call.
+  gl::TextureCube& GetCubeTexture(const std::string& path);
+
+ private:
+  std::map<std::string, std::unique_ptr<MappedTextureCache>> texture_caches_;
+  std::map<std::string, std::shared_future<RgbaImage>> images_;
+  std::map<std::string, std::unique_ptr<gl::Texture2D>> textures_;
+  std::map<std::string, std::unique_ptr<gl::TextureCube>> cube_textures_;
+  std::thread decoder_thread_;
+
+  static RgbaImage Decode(const std::string& path);
+  // Releases the mapping, the cache is only needed for the upload.
+  std::unique_ptr<MappedTextureCache> TakeTextureCache(const std::string& path);
+};
+
+#endif
@@ -1,11 +1,23 @@
 // Copyright (c) Tamas Csala
 
 #include "./ground.hpp"
+#include <algorithm>
 #include <Silice3D/physics/bullet_rigid_body.hpp>
 
-Ground::Ground(GameObject* parent)
+#include "simulation/labyrinth.hpp"
+
+// The extent and the top of ground.obj
+constexpr float kGroundMeshHalfExtent = 1024;
+constexpr float kGroundLevel = -1;
+
+Ground::Ground(GameObject* parent, int labyrinth_radius)
     : MeshObject(parent, "ground.obj") {
+  float half_extent = (labyrinth_radius + 2) * kWallLength;
+  float scale = std::max(half_extent / kGroundMeshHalfExtent, 1.0f);
+  GetTransform().SetScale(glm::vec3{scale, 1, scale});
 
   renderer_->set_cast_shadows(false);
-  AddComponent<Silice3D::BulletRigidBody>(0.0f, GetCollisionShape(), Silice3D::kColStatic);
+  AddComponent<Silice3D::BulletRigidBody>(
+      0.0f, Silice3D::make_unique<btStaticPlaneShape>(btVector3(0, 1, 0), kGroundLevel),
+      Silice3D::kColStatic);
 }
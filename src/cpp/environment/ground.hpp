@@ -7,7 +7,9 @@
 
 class Ground : public Silice3D::MeshObject {
  public:
-  Ground(GameObject *parent);
+  // The ground mesh is stretched to cover the labyrinth, and its collision is
+  // an infinite plane, so nothing falls off the ground of a large labyrinth.
+  Ground(GameObject *parent, int labyrinth_radius);
 };
 
 #endif  // LOD_TREE_H_
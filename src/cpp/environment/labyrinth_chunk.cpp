@@ -0,0 +1,84 @@
+// Copyright (c) Tamas Csala
+
+#include <cstdlib>
+#include <string>
+#include <Silice3D/physics/bullet_rigid_body.hpp>
+
+#include "environment/labyrinth_chunk.hpp"
+
+LabyrinthChunk::LabyrinthChunk(Silice3D::GameObject* parent, LabyrinthChunkCoord chunk,
+                               const LabyrinthChunkWalls& walls,
+                               std::unique_ptr<btCompoundShape> collision_shape, int radius)
+    : GameObject(parent)
+    , chunk_(chunk)
+    , collision_shape_(std::move(collision_shape)) {
+  int border_radius = radius + 1;
+  for (int local_x = 0; local_x < kLabyrinthChunkSize; ++local_x) {
+    for (int local_z = 0; local_z < kLabyrinthChunkSize; ++local_z) {
+      int x = chunk_.min_junction_x() + local_x, z = chunk_.min_junction_z() + local_z;
+      Silice3D::Transform transform;
+      transform.SetLocalPos(LabyrinthGrid::GetJunctionPos(x, z));
+
+      if (std::abs(x) <= radius && std::abs(z) <= radius) {
+        AddComponent<Silice3D::MeshObject>("wall/pillars.obj", transform);
+        uint8_t parts = walls.Get(local_x, local_z);
+        for (int i = 0; i < 4; ++i) {
+          if ((parts >> i) & 1) {
+            wall_part_meshes_[WallPartIndex(local_x, local_z, i)] =
+                AddComponent<Silice3D::MeshObject>("wall/wall" + std::to_string(i+1) + ".obj",
+                                                   transform);
+          }
+        }
+      } else if (std::abs(x) <= border_radius && std::abs(z) <= border_radius) {
+        // The GameWorld checks whether a blast hits them
+        if (std::abs(z) == border_radius) {
+          AddComponent<Silice3D::MeshObject>("wall/bigwall1.obj", transform);
+        }
+        if (std::abs(x) == border_radius) {
+          AddComponent<Silice3D::MeshObject>("wall/bigwall2.obj", transform);
+        }
+      }
+    }
+  }
+
+  AddComponent<Silice3D::BulletRigidBody>(0.0f, collision_shape_.get(), Silice3D::kColStatic);
+}
+
+void LabyrinthChunk::Reset(const LabyrinthChunkWalls& walls, int radius) {
+  for (int local_x = 0; local_x < kLabyrinthChunkSize; ++local_x) {
+    for (int local_z = 0; local_z < kLabyrinthChunkSize; ++local_z) {
+      int x = chunk_.min_junction_x() + local_x, z = chunk_.min_junction_z() + local_z;
+      if (std::abs(x) > radius || std::abs(z) > radius) {
+        continue;
+      }
+      uint8_t parts = walls.Get(local_x, local_z);
+      for (int i = 0; i < 4; ++i) {
+        Silice3D::MeshObject*& mesh = wall_part_meshes_[WallPartIndex(local_x, local_z, i)];
+        bool has_part = (parts >> i) & 1;
+        if (has_part && !mesh) {
+          Silice3D::Transform transform;
+          transform.SetLocalPos(LabyrinthGrid::GetJunctionPos(x, z));
+          mesh = AddComponent<Silice3D::MeshObject>("wall/wall" + std::to_string(i+1) + ".obj",
+                                                    transform);
+        } else if (!has_part && mesh) {
+          RemoveComponent(mesh);
+          mesh = nullptr;
+        }
+      }
+    }
+  }
+}
+
+void LabyrinthChunk::OnWallPartsRemoved(const std::vector<WallPartHit>& parts) {
+  for (const WallPartHit& part : parts) {
+    if (LabyrinthChunkCoord::FromJunction(part.x, part.z) != chunk_) {
+      continue;
+    }
+    int local_x = part.x - chunk_.min_junction_x(), local_z = part.z - chunk_.min_junction_z();
+    Silice3D::MeshObject*& mesh = wall_part_meshes_[WallPartIndex(local_x, local_z, part.part)];
+    if (mesh) {
+      RemoveComponent(mesh);
+      mesh = nullptr;
+    }
+  }
+}
@@ -0,0 +1,45 @@
+// Copyright (c) Tamas Csala
+
+#ifndef ENVIRONMENT_LABYRINTH_CHUNK_HPP_
+#define ENVIRONMENT_LABYRINTH_CHUNK_HPP_
+
+#include <array>
+#include <memory>
+#include <Silice3D/mesh/mesh_object.hpp>
+
+#include "simulation/explosion_damage.hpp"
+#include "simulation/labyrinth_chunk_loader.hpp"
+
+// The scene objects of a loaded chunk of the labyrinth: the meshes of the
+// pillars, wall parts and border walls, and a static body for the chunk's
+// compound collision shape. The meshes are plain MeshObjects without any
+// logic, so the batch renderer draws them.
+class LabyrinthChunk : public Silice3D::GameObject {
+ public:
+  // Creates the meshes (this is where the GL work happens). The GameWorld
+  // rebuilds the collision shape in place when the walls change.
+  LabyrinthChunk(Silice3D::GameObject* parent, LabyrinthChunkCoord chunk,
+                 const LabyrinthChunkWalls& walls,
+                 std::unique_ptr<btCompoundShape> collision_shape, int radius);
+
+  LabyrinthChunkCoord chunk() const { return chunk_; }
+
+  // Switches to the walls of a new labyrinth with the same radius, only the
+  // wall part meshes that differ are created or removed.
+  void Reset(const LabyrinthChunkWalls& walls, int radius);
+
+  // Removes the meshes of the parts, the ones in other chunks are ignored.
+  void OnWallPartsRemoved(const std::vector<WallPartHit>& parts);
+
+ private:
+  LabyrinthChunkCoord chunk_;
+  std::unique_ptr<btCompoundShape> collision_shape_;
+  // The meshes of the standing wall parts, four per junction
+  std::array<Silice3D::MeshObject*, kLabyrinthChunkSize * kLabyrinthChunkSize * 4> wall_part_meshes_{};
+
+  static int WallPartIndex(int local_x, int local_z, int part) {
+    return (local_x * kLabyrinthChunkSize + local_z) * 4 + part;
+  }
+};
+
+#endif
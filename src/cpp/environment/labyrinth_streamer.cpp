@@ -0,0 +1,40 @@
+// Copyright (c) Tamas Csala
+
+#include <utility>
+
+#include "environment/labyrinth_streamer.hpp"
+#include "simulation/profiler.hpp"
+
+LabyrinthStreamer::LabyrinthStreamer(Silice3D::GameObject* parent, int radius)
+    : GameObject(parent), radius_(radius) {
+}
+
+void LabyrinthStreamer::AddChunk(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls,
+                                 std::unique_ptr<btCompoundShape> collision_shape) {
+  PYROMAZE_PROFILE_ZONE("LabyrinthStreamer::AddChunk");
+  chunks_[chunk.Key()] = AddComponent<LabyrinthChunk>(chunk, walls, std::move(collision_shape),
+                                                      radius_);
+}
+
+void LabyrinthStreamer::ResetChunk(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls) {
+  auto iter = chunks_.find(chunk.Key());
+  if (iter != chunks_.end()) {
+    iter->second->Reset(walls, radius_);
+  }
+}
+
+void LabyrinthStreamer::RemoveWallParts(LabyrinthChunkCoord chunk,
+                                        const std::vector<WallPartHit>& parts) {
+  auto iter = chunks_.find(chunk.Key());
+  if (iter != chunks_.end()) {
+    iter->second->OnWallPartsRemoved(parts);
+  }
+}
+
+void LabyrinthStreamer::RemoveChunk(LabyrinthChunkCoord chunk) {
+  auto iter = chunks_.find(chunk.Key());
+  if (iter != chunks_.end()) {
+    RemoveComponent(iter->second);
+    chunks_.erase(iter);
+  }
+}
@@ -0,0 +1,32 @@
+// Copyright (c) Tamas Csala
+
+#ifndef ENVIRONMENT_LABYRINTH_STREAMER_HPP_
+#define ENVIRONMENT_LABYRINTH_STREAMER_HPP_
+
+#include <memory>
+#include <unordered_map>
+
+#include "environment/labyrinth_chunk.hpp"
+
+// The parent of the loaded chunks. The GameWorld streams the chunks around
+// the player (their walls and collision are built on its loader thread), the
+// streamer creates and removes their scene objects as it is told.
+class LabyrinthStreamer : public Silice3D::GameObject {
+ public:
+  LabyrinthStreamer(Silice3D::GameObject* parent, int radius);
+
+  size_t loaded_chunk_count() const { return chunks_.size(); }
+
+  void AddChunk(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls,
+                std::unique_ptr<btCompoundShape> collision_shape);
+  // Switches a kept chunk to the walls of a new labyrinth.
+  void ResetChunk(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls);
+  void RemoveWallParts(LabyrinthChunkCoord chunk, const std::vector<WallPartHit>& parts);
+  void RemoveChunk(LabyrinthChunkCoord chunk);
+
+ private:
+  int radius_;
+  std::unordered_map<uint64_t, LabyrinthChunk*> chunks_;
+};
+
+#endif
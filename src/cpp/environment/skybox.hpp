@@ -17,7 +17,8 @@ class Skybox : public Silice3D::GameObject {
   gl::CubeShape cube_;
 
   Silice3D::ShaderProgram prog_;
-  gl::TextureCube texture_;
+  // Owned by the AssetManager
+  gl::TextureCube* texture_;
   gl::LazyUniform<glm::mat4> uProjectionMatrix_;
   gl::LazyUniform<glm::mat3> uCameraMatrix_;
 
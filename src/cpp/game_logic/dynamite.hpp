@@ -3,20 +3,30 @@
 #ifndef DYNAMITE_HPP_
 #define DYNAMITE_HPP_
 
-#include <Silice3D/common/oglwrap.hpp>
-#include <Silice3D/mesh/mesh_object.hpp>
+#include <Silice3D/core/game_object.hpp>
 
 #include "game_logic/fire.hpp"
+#include "simulation/game_world.hpp"
 
-class Dynamite : public Silice3D::MeshObject {
+class DynamiteRenderer;
+
+// Shows a dynamite of the GameWorld, drawn by the scene's DynamiteRenderer.
+// The world burns its fuse down, and removes it when it detonates.
+class Dynamite : public Silice3D::GameObject {
  public:
-  Dynamite(GameObject *parent,
-           const Silice3D::Transform& initial_transform = Silice3D::Transform{},
-           double time_to_explode = 5.0);
+  Dynamite(GameObject *parent, const Silice3D::Transform& initial_transform,
+           const DynamiteState* state);
+  ~Dynamite();
+
+  // The burning end of the fuse, in model space
+  const glm::vec3& fire_pos() const { return fire_pos_; }
 
  private:
+  friend class DynamiteRenderer;
+  const DynamiteState* state_;
+  DynamiteRenderer* renderer_;
   Fire* fire_ = nullptr;
-  double spawn_time_, time_to_explode_ = 5.0;
+  glm::vec3 fire_pos_;
 
   virtual void Update() override;
 };
@@ -0,0 +1,143 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cstddef>
+#include <Silice3D/core/scene.hpp>
+
+#include "game_logic/dynamite_renderer.hpp"
+#include "game_logic/dynamite.hpp"
+#include "simulation/mesh_cache.hpp"
+#include "simulation/profiler.hpp"
+#include "./main_scene.hpp"
+
+// The attribute locations of dynamite.vert
+static const GLuint kPositionLocation = 0;
+static const GLuint kTexCoordLocation = 1;
+static const GLuint kNormalLocation = 2;
+static const GLuint kModelMatrixLocation = 4;  // 4 columns
+static const GLuint kFirePosLocation = 8;
+
+DynamiteRenderer::DynamiteRenderer(GameObject* parent)
+    : GameObject(parent)
+    , prog_{GetScene()->GetShaderManager()->GetShader("dynamite.vert"),
+            GetScene()->GetShaderManager()->GetShader("dynamite.frag")}
+    , uProjectionMatrix_(prog_, "uProjectionMatrix")
+    , uCameraMatrix_(prog_, "uCameraMatrix")
+    , texture_(&static_cast<MainScene*>(GetScene())->GetAssets()->GetTexture(kDynamiteImage)) {
+  gl::Use(prog_);
+  prog_.validate();
+  gl::UniformSampler(prog_, "uDiffuseTexture") = Silice3D::kDiffuseTextureSlot;
+  gl::Unuse(prog_);
+
+  gl::Bind(vao_);
+
+  Aabb bounds;
+  gl::Bind(vertices_);
+  gl::Bind(indices_);
+  std::unique_ptr<MappedMeshCache> cache = MappedMeshCache::Open(kDynamiteMesh);
+  if (cache) {
+    const MeshCacheHeader& header = cache->header();
+    vertices_.data(header.vertex_count * sizeof(MeshVertex), cache->vertices());
+    indices_.data(header.index_count * sizeof(uint32_t), cache->indices());
+    index_count_ = header.index_count;
+    bounds = header.bounds;
+  } else {
+    ObjMesh mesh = ParseObjMesh(kDynamiteMesh);
+    vertices_.data(mesh.vertices);
+    indices_.data(mesh.indices);
+    index_count_ = mesh.indices.size();
+    bounds = LoadObjBounds(kDynamiteMesh);
+  }
+
+  gl::VertexAttrib(kPositionLocation).pointer(
+      3, gl::kFloat, false, sizeof(MeshVertex),
+      reinterpret_cast<const void*>(offsetof(MeshVertex, position))).enable();
+  gl::VertexAttrib(kTexCoordLocation).pointer(
+      2, gl::kFloat, false, sizeof(MeshVertex),
+      reinterpret_cast<const void*>(offsetof(MeshVertex, tex_coord))).enable();
+  gl::VertexAttrib(kNormalLocation).pointer(
+      3, gl::kFloat, false, sizeof(MeshVertex),
+      reinterpret_cast<const void*>(offsetof(MeshVertex, normal))).enable();
+
+  gl::Bind(instance_model_matrices_);
+  for (GLuint column = 0; column < 4; ++column) {
+    gl::VertexAttrib attrib(kModelMatrixLocation + column);
+    attrib.pointer(4, gl::kFloat, false, sizeof(glm::mat4),
+                   reinterpret_cast<const void*>(column * sizeof(glm::vec4))).enable();
+    attrib.divisor(1);
+  }
+
+  gl::Bind(instance_fire_positions_);
+  gl::VertexAttrib fire_pos_attrib(kFirePosLocation);
+  fire_pos_attrib.setup<glm::vec3>().enable();
+  fire_pos_attrib.divisor(1);
+
+  gl::Unbind(vao_);
+  gl::Unbind(instance_fire_positions_);
+  gl::Unbind(indices_);
+
+  glm::vec3 half_extent = (bounds.max - bounds.min) / 2.0f;
+  glm::vec3 center = (bounds.max + bounds.min) / 2.0f;
+  box_shape_.reset(new btBoxShape(btVector3(half_extent.x, half_extent.y, half_extent.z)));
+  collision_shape_.reset(new btCompoundShape{});
+  btTransform transform;
+  transform.setIdentity();
+  transform.setOrigin(btVector3(center.x, center.y, center.z));
+  collision_shape_->addChildShape(transform, box_shape_.get());
+}
+
+DynamiteRenderer::~DynamiteRenderer() {
+  // The dynamites might outlive the renderer when the scene is destroyed
+  for (Dynamite* dynamite : dynamites_) {
+    dynamite->renderer_ = nullptr;
+  }
+}
+
+void DynamiteRenderer::Register(Dynamite* dynamite) {
+  dynamites_.push_back(dynamite);
+}
+
+void DynamiteRenderer::Unregister(Dynamite* dynamite) {
+  auto iter = std::find(dynamites_.begin(), dynamites_.end(), dynamite);
+  if (iter != dynamites_.end()) {
+    *iter = dynamites_.back();
+    dynamites_.pop_back();
+  }
+}
+
+void DynamiteRenderer::Render() {
+  PYROMAZE_PROFILE_ZONE("DynamiteRenderer::Render");
+  if (dynamites_.empty()) {
+    return;
+  }
+
+  model_matrices_.clear();
+  fire_positions_.clear();
+  for (const Dynamite* dynamite : dynamites_) {
+    model_matrices_.push_back(dynamite->GetTransform().GetMatrix());
+    fire_positions_.push_back(dynamite->fire_pos());
+  }
+
+  gl::Use(prog_);
+  prog_.Update();
+
+  auto cam = GetScene()->GetCamera();
+  uCameraMatrix_ = cam->GetCameraMatrix();
+  uProjectionMatrix_ = cam->GetProjectionMatrix();
+
+  gl::Bind(instance_model_matrices_);
+  instance_model_matrices_.data(model_matrices_, gl::kStreamDraw);
+  gl::Bind(instance_fire_positions_);
+  instance_fire_positions_.data(fire_positions_, gl::kStreamDraw);
+  gl::Unbind(instance_fire_positions_);
+
+  gl::BindToTexUnit(*texture_, Silice3D::kDiffuseTextureSlot);
+
+  gl::Bind(vao_);
+  gl::DrawElementsInstanced(gl::kTriangles, index_count_, gl::kUnsignedInt, nullptr,
+                            GLsizei(dynamites_.size()));
+  gl::Unbind(vao_);
+
+  gl::Unbind(*texture_);
+  gl::Unuse(prog_);
+}
@@ -0,0 +1,54 @@
+// Copyright (c) Tamas Csala
+
+#ifndef DYNAMITE_RENDERER_HPP_
+#define DYNAMITE_RENDERER_HPP_
+
+#include <memory>
+#include <vector>
+#include <btBulletDynamicsCommon.h>
+#include <Silice3D/common/oglwrap.hpp>
+#include <Silice3D/core/game_object.hpp>
+#include <Silice3D/shaders/shader_manager.hpp>
+
+class Dynamite;
+
+constexpr const char kDynamiteMesh[] = "src/resource/dynamite.obj";
+
+// Draws every dynamite of the scene with one instanced draw call. Besides the
+// model matrix, each instance has the position of its burning fuse end, so
+// the fuses burn individually (with a shared uniform the last dynamite's
+// fuse would win). The mesh comes from the mesh cache if it's up to date.
+class DynamiteRenderer : public Silice3D::GameObject {
+ public:
+  explicit DynamiteRenderer(GameObject* parent);
+  ~DynamiteRenderer();
+
+  // Fitted to the mesh, shared by the dynamites' bodies.
+  btCollisionShape* GetCollisionShape() { return collision_shape_.get(); }
+
+  void Register(Dynamite* dynamite);
+  void Unregister(Dynamite* dynamite);
+
+ private:
+  std::vector<Dynamite*> dynamites_;
+  std::unique_ptr<btBoxShape> box_shape_;
+  // The box, moved to the center of the mesh
+  std::unique_ptr<btCompoundShape> collision_shape_;
+
+  Silice3D::ShaderProgram prog_;
+  gl::LazyUniform<glm::mat4> uProjectionMatrix_, uCameraMatrix_;
+  // Owned by the AssetManager
+  gl::Texture2D* texture_;
+
+  gl::VertexArray vao_;
+  gl::ArrayBuffer vertices_;
+  gl::IndexBuffer indices_;
+  GLsizei index_count_ = 0;
+  gl::ArrayBuffer instance_model_matrices_, instance_fire_positions_;
+  std::vector<glm::mat4> model_matrices_;
+  std::vector<glm::vec3> fire_positions_;
+
+  virtual void Render() override;
+};
+
+#endif
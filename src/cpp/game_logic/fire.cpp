@@ -4,165 +4,73 @@
 #include <Silice3D/core/scene.hpp>
 
 #include "game_logic/fire.hpp"
-#include "game_logic/explodable.hpp"
+#include "simulation/game_rules.hpp"
+#include "simulation/profiler.hpp"
+#include "./main_scene.hpp"
 
-bool Particle::IsAlive(float current_time) {
-  return born_at + lifespan > current_time;
-}
-
-void Particle::Update(float dt) {
-  pos += speed * dt;
-  speed += accel * dt;
-}
+static const glm::vec3 kFireLightColor{5.0f};
+static const glm::vec3 kLightAttenuation{1, 0.1, 0.1};
 
 ParticleSystem::ParticleSystem(GameObject* parent, ParticleGen generator,
                                int max_particles_at_once, int max_particle_per_sec,
                                int max_particle_count)
     : GameObject(parent)
-    , cube_({gl::CubeShape::kPosition, gl::CubeShape::kNormal})
-    , prog_{GetScene()->GetShaderManager()->GetShader("fire.vert"),
-            GetScene()->GetShaderManager()->GetShader("fire.frag")}
-    , uProjectionMatrix_(prog_, "uProjectionMatrix")
-    , uCameraMatrix_(prog_, "uCameraMatrix")
-    , uModelMatrix_{prog_, "uModelMatrix"}
-    , uLifeTime_{prog_, "uLifeTime"}
-    , generator_{generator}
-    , max_particles_at_once_{max_particles_at_once}
-    , max_particle_per_sec_{max_particle_per_sec}
-    , max_particle_count_{max_particle_count} {
-  gl::Use(prog_);
-  prog_.validate();
-  (prog_ | "aPosition").bindLocation(cube_.kPosition);
-  (prog_ | "aNormal").bindLocation(cube_.kNormal);
+    , resources_(static_cast<MainScene*>(GetScene())->GetParticleResources())
+    , simulation_{generator,
+                  static_cast<MainScene*>(GetScene())->GetRandom(RandomStream::kParticles).Fork(),
+                  max_particles_at_once, max_particle_per_sec, max_particle_count}
+    , buffer_{resources_, size_t(max_particles_at_once)} {
+}
 
-  particles_.resize(max_particles_at_once_);
-  gl::Unuse(prog_);
+void ParticleSystem::Simulate(const glm::vec3& pos, float current_time, float dt) {
+  simulation_.Update(pos, current_time, dt);
 }
 
 void ParticleSystem::Update() {
-  float current_time = scene_->GetGameTime().GetCurrentTime();
-  float dt = scene_->GetGameTime().GetDeltaTime();
-  newParticlesToSpawn_ += dt * max_particle_per_sec_;
-
-  if (max_particle_count_ >= particles_generated_) {
-    bool is_particle_still_alive = false;
-    for (Particle& particle : particles_) {
-      if (particle.IsAlive(current_time)) {
-        is_particle_still_alive = true;
-      }
-    }
-    if (!is_particle_still_alive) {
-      GetParent()->RemoveComponent(this);
-      return;
-    }
+  PYROMAZE_PROFILE_ZONE("ParticleSystem::Update");
+  if (simulation_.IsFinished()) {
+    GetParent()->RemoveComponent(this);
+    return;
   }
 
-  for (Particle& particle : particles_) {
-    if (particle.IsAlive(current_time)) {
-      particle.Update(dt);
-    } else if (newParticlesToSpawn_ >= 1 &&
-               (max_particle_count_ < 0 ||
-                particles_generated_ < max_particle_count_)) {
-      particle = generator_(GetTransform().GetPos(), current_time);
-      --newParticlesToSpawn_;
-      particles_generated_++;
-    }
-  }
+  Simulate(GetTransform().GetPos(), static_cast<MainScene*>(scene_)->GetGameplayTime(),
+           static_cast<MainScene*>(scene_)->GetGameplayDeltaTime());
 }
 
 void ParticleSystem::Render() {
-  gl::Use(prog_);
-  prog_.Update();
-
-  auto cam = GetScene()->GetCamera();
-  uCameraMatrix_ = cam->GetCameraMatrix();
-  uProjectionMatrix_ = cam->GetProjectionMatrix();
-
-  float current_time = scene_->GetGameTime().GetCurrentTime();
-
-  gl::TemporaryEnable blend{gl::kBlend};
-  gl::BlendFunc(gl::kSrcAlpha, gl::kOneMinusSrcAlpha);
-
-  for (Particle& particle : particles_) {
-    if (particle.IsAlive(current_time)) {
-      uLifeTime_ = current_time - particle.born_at;
-      glm::vec3 scale{particle.scale};
-      uModelMatrix_.set(glm::translate(particle.pos) * glm::scale(scale));
-      cube_.render();
-    }
-  }
-  gl::Unuse(prog_);
-}
-
-Particle FireParticle(glm::vec3 startpos, float current_time) {
-  Particle p;
-  p.born_at = current_time;
-  p.pos = startpos;
-
-  // Make the particles converge at (0, 4, 0)
-  p.accel = 0.5f*normalize(startpos + glm::vec3{0, 4, 0} - p.pos + 0.2f*Silice3D::Math::RandomDir());
-  p.speed = 0.2f*Silice3D::Math::RandomDir() + 4.0f*p.accel;
-
-  // 1 - 3 sec lifespan
-  p.lifespan = (rand()%20) / 10.0 + 1;
-
-  p.scale = 0.025 + 0.025*Silice3D::Math::Rand01();
-  return p;
-}
-
-Particle ExplosionParticle(glm::vec3 startpos, float current_time) {
-  Particle p;
-  p.born_at = current_time;
-  p.pos = startpos + Silice3D::Math::RandomDir();
-  p.accel = (5.0f + 5.0f*Silice3D::Math::Rand01())*normalize(Silice3D::Math::RandomDir());
-  // p.accel.y = std::max(p.accel.y, 0.0f);
-  p.speed = 2.0f*p.accel;
-
-  // 0.5 - 1 sec lifespan
-  p.lifespan = (rand()%5) / 10.0 + 0.5;
-
-  p.scale = 0.1 + 0.1*Silice3D::Math::Rand01();
-  return p;
+  PYROMAZE_PROFILE_ZONE("ParticleSystem::Render");
+  buffer_.Render(&simulation_, static_cast<MainScene*>(scene_)->GetGameplayTime(),
+                 GetScene()->GetCamera());
 }
 
 
 Fire::Fire(GameObject* parent)
-    : ParticleSystem(parent, FireParticle, 1000, 200) {
-  glm::vec3 color = glm::vec3{5.0f};
-  glm::vec3 attenuation = glm::vec3{1, 0.1, 0.1};
-  AddComponent<Silice3D::PointLightSource>(color, attenuation);
+    : ParticleSystem(parent, FireParticle, GameRules::kFireMaxParticlesAtOnce,
+                     GameRules::kFireParticlesPerSecond) {
+  AddComponent<Silice3D::PointLightSource>(kFireLightColor, kLightAttenuation);
 }
 
 void Fire::Update() {
   ParticleSystem::Update();
 }
 
-Explosion::Explosion(GameObject* parent)
-    : ParticleSystem(parent, ExplosionParticle, 2800, 0, 3000) {
-  glm::vec3 color = glm::vec3{1000.0f};
-  glm::vec3 attenuation = glm::vec3{1, 0.1, 0.1};
-  light_source = AddComponent<Silice3D::PointLightSource>(color, attenuation);
-  born_at_ = scene_->GetGameTime().GetCurrentTime();
+Explosion::Explosion(GameObject* parent, int particle_budget)
+    : ParticleSystem(parent, ExplosionParticle, GameRules::ExplosionMaxParticlesAtOnce(particle_budget),
+                     0, particle_budget)
+    , burst_size_(GameRules::ExplosionBurstSize(particle_budget)) {
+  light_source = AddComponent<Silice3D::PointLightSource>(glm::vec3{1000.0f}, kLightAttenuation);
+  born_at_ = static_cast<MainScene*>(scene_)->GetGameplayTime();
+}
+
+void Explosion::Simulate(const glm::vec3& pos, float current_time, float dt) {
+  simulation_.SpawnBurst(pos, current_time, burst_size_);
+  ParticleSystem::Simulate(pos, current_time, dt);
 }
 
 void Explosion::Update() {
-  float current_time = scene_->GetGameTime().GetCurrentTime();
-  for (Particle& particle : particles_) {
-    if (!particle.IsAlive(current_time) && rand()%8 == 0 &&
-        particles_generated_ < max_particle_count_) {
-      particle = generator_(GetTransform().GetPos(), current_time);
-      particles_generated_++;
-    }
-  }
+  PYROMAZE_PROFILE_ZONE("Explosion::Update");
+  float current_time = static_cast<MainScene*>(scene_)->GetGameplayTime();
   float life_time = current_time - born_at_;
-  if (life_time < 0.5) {
-    scene_->EnumerateChildren(true, [&](Silice3D::GameObject* obj) {
-      Explodable* explodable = dynamic_cast<Explodable*>(obj);
-      if (explodable != nullptr) {
-        explodable->ReactToExplosion(GetTransform().GetPos(), 10);
-      }
-    });
-  }
   float lightness = std::min(std::pow(100000, 1.0-sqrt(life_time)), 1000.0);
   light_source->SetColor(glm::vec3{lightness});
   ParticleSystem::Update();
@@ -4,23 +4,12 @@
 #define FIRE_HPP_
 
 #include <Silice3D/common/oglwrap.hpp>
-#include <oglwrap/shapes/cube_shape.h>
-
 #include <Silice3D/core/game_object.hpp>
 #include <Silice3D/shaders/shader_manager.hpp>
 
-struct Particle {
-  glm::vec3 pos, speed, accel;
-  float born_at = -1, lifespan = -1;
-  float scale = 0;
-
-  Particle() = default; // dead particle
-  Particle(glm::vec3 startpos, float current_time);
-  bool IsAlive(float current_time);
-  void Update(float dt);
-};
-
-typedef Particle (*ParticleGen)(glm::vec3 startpos, float current_time);
+#include "game_logic/particle_resources.hpp"
+#include "simulation/game_rules.hpp"
+#include "simulation/particle_simulation.hpp"
 
 class ParticleSystem : public Silice3D::GameObject {
  public:
@@ -29,17 +18,11 @@ class ParticleSystem : public Silice3D::GameObject {
                  int max_partice_count = -1);
 
  protected:
-  gl::CubeShape cube_;
-
-  Silice3D::ShaderProgram prog_;
-  gl::LazyUniform<glm::mat4> uProjectionMatrix_, uCameraMatrix_, uModelMatrix_;
-  gl::LazyUniform<float> uLifeTime_;
+  ParticleResources* resources_;
+  ParticleSimulation simulation_;
+  ParticleBuffer buffer_;
 
-  ParticleGen generator_;
-  float newParticlesToSpawn_ = 0.0;
-  std::vector<Particle> particles_;
-  int particles_generated_ = 0;
-  int max_particles_at_once_, max_particle_per_sec_, max_particle_count_;
+  virtual void Simulate(const glm::vec3& pos, float current_time, float dt);
 
   virtual void Update() override;
   virtual void Render() override;
@@ -53,14 +36,17 @@ private:
   virtual void Update() override;
 };
 
+// The visual effect of a blast, the damage is resolved by the scene (see
+// MainScene::ResolveDetonations).
 class Explosion : public ParticleSystem {
 public:
-  Explosion(GameObject* parent);
+  Explosion(GameObject* parent, int particle_budget = GameRules::kExplosionParticleCount);
 
 private:
   Silice3D::PointLightSource* light_source = nullptr;
   float born_at_;
-
+  int burst_size_;
+  virtual void Simulate(const glm::vec3& pos, float current_time, float dt) override;
   virtual void Update() override;
 };
 
@@ -0,0 +1,200 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cstddef>
+#include <Silice3D/core/scene.hpp>
+
+#include "game_logic/particle_resources.hpp"
+
+// A cube with unit edges, as 12 triangles with per face normals
+static void CreateCube(std::vector<glm::vec3>* positions,
+                       std::vector<glm::vec3>* normals) {
+  for (int axis = 0; axis < 3; ++axis) {
+    for (float sign : {-1.0f, 1.0f}) {
+      glm::vec3 normal{0.0f}, u{0.0f}, v{0.0f};
+      normal[axis] = sign;
+      u[(axis + 1) % 3] = 1.0f;
+      v[(axis + 2) % 3] = sign;
+      glm::vec3 center = 0.5f * normal;
+      glm::vec3 corners[4] = {
+        center + 0.5f*(-u - v), center + 0.5f*(u - v),
+        center + 0.5f*(u + v), center + 0.5f*(-u + v)
+      };
+      for (int i : {0, 1, 2, 0, 2, 3}) {
+        positions->push_back(corners[i]);
+        normals->push_back(normal);
+      }
+    }
+  }
+}
+
+ParticleResources::ParticleResources(Silice3D::ShaderManager* shader_manager)
+    : prog_{shader_manager->GetShader("fire.vert"),
+            shader_manager->GetShader("fire.frag")}
+    , uProjectionMatrix_(prog_, "uProjectionMatrix")
+    , uCameraMatrix_(prog_, "uCameraMatrix")
+    , uCurrentTime_(prog_, "uCurrentTime") {
+  gl::Use(prog_);
+  prog_.validate();
+  gl::Unuse(prog_);
+
+  std::vector<glm::vec3> positions, normals;
+  CreateCube(&positions, &normals);
+
+  gl::Bind(cube_positions_);
+  cube_positions_.data(positions);
+  gl::Bind(cube_normals_);
+  cube_normals_.data(normals);
+
+  gl::Bind(vao_);
+  gl::Bind(cube_positions_);
+  (prog_ | "aPosition").setup<glm::vec3>().enable();
+  gl::Bind(cube_normals_);
+  (prog_ | "aNormal").setup<glm::vec3>().enable();
+
+  // Every system draws from its own first slot with a base instance, so the
+  // attributes always point at the beginning of the buffer.
+  gl::Bind(records_);
+  const char* names[] = {"aStartPosScale", "aSpeedBornAt", "aAccelDeathAt"};
+  const size_t offsets[] = {offsetof(ParticleRecord, pos_scale),
+                            offsetof(ParticleRecord, speed_born_at),
+                            offsetof(ParticleRecord, accel_death_at)};
+  for (int i = 0; i < 3; ++i) {
+    gl::VertexAttrib attrib = prog_ | names[i];
+    attrib.pointer(4, gl::kFloat, false, sizeof(ParticleRecord),
+                   reinterpret_cast<const void*>(offsets[i])).enable();
+    attrib.divisor(1);
+  }
+
+  gl::Unbind(vao_);
+  gl::Unbind(records_);
+}
+
+ParticleResources::~ParticleResources() {
+  // The particle systems might outlive the resources when the scene is
+  // destroyed
+  for (ParticleBuffer* buffer : buffers_) {
+    buffer->resources_ = nullptr;
+  }
+}
+
+ParticleResources::SlotRange ParticleResources::AllocateSlots(uint32_t count) {
+  if (count == 0) {
+    return SlotRange{0, 0};
+  }
+  auto iter = std::find_if(free_ranges_.begin(), free_ranges_.end(),
+                           [count](const SlotRange& range) { return range.count >= count; });
+  if (iter == free_ranges_.end()) {
+    uint32_t new_capacity = std::max(2 * slot_capacity_, slot_capacity_ + count);
+    FreeSlots(SlotRange{slot_capacity_, new_capacity - slot_capacity_});
+    slot_capacity_ = new_capacity;
+    gl::Bind(records_);
+    records_.data(slot_capacity_ * sizeof(ParticleRecord), nullptr, gl::kDynamicDraw);
+    gl::Unbind(records_);
+    records_generation_++;
+    iter = free_ranges_.end() - 1;
+  }
+
+  SlotRange allocated{iter->first, count};
+  iter->first += count;
+  iter->count -= count;
+  if (iter->count == 0) {
+    free_ranges_.erase(iter);
+  }
+  return allocated;
+}
+
+void ParticleResources::FreeSlots(SlotRange range) {
+  if (range.count == 0) {
+    return;
+  }
+  auto next = std::lower_bound(free_ranges_.begin(), free_ranges_.end(), range,
+                               [](const SlotRange& a, const SlotRange& b) { return a.first < b.first; });
+  if (next != free_ranges_.end() && range.first + range.count == next->first) {
+    range.count += next->count;
+    next = free_ranges_.erase(next);
+  }
+  if (next != free_ranges_.begin()) {
+    SlotRange& prev = *(next - 1);
+    if (prev.first + prev.count == range.first) {
+      prev.count += range.count;
+      return;
+    }
+  }
+  free_ranges_.insert(next, range);
+}
+
+ParticleBuffer::ParticleBuffer(ParticleResources* resources, size_t slot_count)
+    : resources_(resources)
+    , slots_(resources_->AllocateSlots(uint32_t(slot_count)))
+    , records_generation_(resources_->records_generation_) {
+  resources_->buffers_.push_back(this);
+}
+
+ParticleBuffer::~ParticleBuffer() {
+  if (!resources_) {
+    return;
+  }
+  resources_->FreeSlots(slots_);
+  std::vector<ParticleBuffer*>& buffers = resources_->buffers_;
+  auto iter = std::find(buffers.begin(), buffers.end(), this);
+  if (iter != buffers.end()) {
+    *iter = buffers.back();
+    buffers.pop_back();
+  }
+}
+
+void ParticleBuffer::UploadRecords(const ParticleSimulation& simulation,
+                                   uint32_t first_slot, size_t count) {
+  resources_->records_.subData((slots_.first + first_slot) * sizeof(ParticleRecord),
+                               count * sizeof(ParticleRecord),
+                               &simulation.record(first_slot));
+}
+
+void ParticleBuffer::Render(ParticleSimulation* simulation, float current_time,
+                            Silice3D::ICamera* camera) {
+  if (!resources_ || simulation->slot_count() == 0) {
+    return;
+  }
+
+  gl::Bind(resources_->records_);
+  if (records_generation_ != resources_->records_generation_) {
+    // The record buffer grew since the last upload
+    records_generation_ = resources_->records_generation_;
+    simulation->ClearSpawnedSlots();
+    UploadRecords(*simulation, 0, simulation->slot_count());
+  } else if (!simulation->spawned_slots().empty()) {
+    // The free list hands out the slots in runs, a run is one upload
+    upload_slots_ = simulation->spawned_slots();
+    simulation->ClearSpawnedSlots();
+    std::sort(upload_slots_.begin(), upload_slots_.end());
+
+    for (size_t begin = 0; begin < upload_slots_.size();) {
+      size_t end = begin + 1;
+      while (end < upload_slots_.size() && upload_slots_[end] == upload_slots_[end-1] + 1) {
+        ++end;
+      }
+      UploadRecords(*simulation, upload_slots_[begin], end - begin);
+      begin = end;
+    }
+  }
+  gl::Unbind(resources_->records_);
+
+  Silice3D::ShaderProgram& prog = resources_->prog_;
+  gl::Use(prog);
+  prog.Update();
+
+  resources_->uCameraMatrix_ = camera->GetCameraMatrix();
+  resources_->uProjectionMatrix_ = camera->GetProjectionMatrix();
+  resources_->uCurrentTime_ = current_time;
+
+  gl::TemporaryEnable blend{gl::kBlend};
+  gl::BlendFunc(gl::kSrcAlpha, gl::kOneMinusSrcAlpha);
+
+  gl::Bind(resources_->vao_);
+  glDrawArraysInstancedBaseInstance(GL_TRIANGLES, 0, 36, GLsizei(simulation->slot_count()),
+                                    slots_.first);
+  gl::Unbind(resources_->vao_);
+
+  gl::Unuse(prog);
+}
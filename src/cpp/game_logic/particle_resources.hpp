@@ -0,0 +1,79 @@
+// Copyright (c) Tamas Csala
+
+#ifndef PARTICLE_RESOURCES_HPP_
+#define PARTICLE_RESOURCES_HPP_
+
+#include <cstdint>
+#include <vector>
+#include <Silice3D/common/oglwrap.hpp>
+#include <Silice3D/shaders/shader_manager.hpp>
+
+#include "simulation/particle_simulation.hpp"
+
+namespace Silice3D { class ICamera; }
+class ParticleBuffer;
+
+// The GL objects needed to render particles: the shader program, a cube mesh,
+// and one record buffer with its VAO. They are created once per scene and
+// shared by every ParticleSystem: each system gets a range of the record
+// buffer's slots, so spawning an effect doesn't create GL objects.
+class ParticleResources {
+ public:
+  explicit ParticleResources(Silice3D::ShaderManager* shader_manager);
+  ~ParticleResources();
+
+ private:
+  friend class ParticleBuffer;
+
+  struct SlotRange {
+    uint32_t first, count;
+  };
+
+  Silice3D::ShaderProgram prog_;
+  gl::LazyUniform<glm::mat4> uProjectionMatrix_, uCameraMatrix_;
+  gl::LazyUniform<float> uCurrentTime_;
+
+  gl::ArrayBuffer cube_positions_, cube_normals_;
+  gl::VertexArray vao_;
+  gl::ArrayBuffer records_;
+  uint32_t slot_capacity_ = 0;
+  // Reallocating the record buffer loses its content, the buffers notice it
+  // from this and upload their records again.
+  uint32_t records_generation_ = 0;
+  // Sorted by first, the neighbouring ranges are merged
+  std::vector<SlotRange> free_ranges_;
+  std::vector<ParticleBuffer*> buffers_;
+
+  // The first free range that is big enough, the record buffer grows if
+  // there's none.
+  SlotRange AllocateSlots(uint32_t count);
+  void FreeSlots(SlotRange range);
+};
+
+// The spawn records of one particle system on the GPU, in its slot range of
+// the shared record buffer. fire.vert evaluates the particles at the current
+// time, so only the newly spawned records are uploaded.
+class ParticleBuffer {
+ public:
+  ParticleBuffer(ParticleResources* resources, size_t slot_count);
+  ~ParticleBuffer();
+
+  // Uploads the spawned slots (and clears them in the simulation), then draws
+  // every used slot with one instanced draw call, the dead ones are culled
+  // in the vertex shader.
+  void Render(ParticleSimulation* simulation, float current_time,
+              Silice3D::ICamera* camera);
+
+ private:
+  friend class ParticleResources;
+
+  // Null once the resources are destroyed
+  ParticleResources* resources_;
+  ParticleResources::SlotRange slots_;
+  uint32_t records_generation_;
+  std::vector<uint32_t> upload_slots_;
+
+  void UploadRecords(const ParticleSimulation& simulation, uint32_t first_slot, size_t count);
+};
+
+#endif
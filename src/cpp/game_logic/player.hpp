@@ -5,16 +5,13 @@
 
 #include <Silice3D/core/game_object.hpp>
 
-#include "game_logic/explodable.hpp"
-
-class Player : public Silice3D::GameObject, public Explodable {
+// The player's keys, the GameWorld tracks the player through the camera.
+class Player : public Silice3D::GameObject {
  public:
-  Player(Silice3D::GameObject* parent);
+  using GameObject::GameObject;
 
  private:
   virtual void KeyAction(int key, int scancode, int action, int mods) override;
-
-  virtual void ReactToExplosion(const glm::dvec3& exp_position, double exp_radius) override;
 };
 
 #endif
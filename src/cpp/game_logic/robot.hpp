@@ -6,23 +6,24 @@
 #include <Silice3D/mesh/mesh_object.hpp>
 #include <Silice3D/physics/bullet_rigid_body.hpp>
 
-#include "game_logic/explodable.hpp"
+#include "simulation/robot_swarm.hpp"
 
-class Player;
-
-class Robot : public Silice3D::MeshObject, public Explodable {
+// Shows a robot of the GameWorld, should be created through
+// RobotManager::AddRobot. The logic is in RobotSwarm, which drives the body
+// of the robot.
+class Robot : public Silice3D::MeshObject {
  public:
   Robot(Silice3D::GameObject* parent, const Silice3D::Transform& initial_transform,
-        Player* player);
+        const RobotState* state);
+
+  btRigidBody* GetBtRigidBody() { return rbody_->GetBtRigidBody(); }
 
  private:
-  Player* player_;
+  const RobotState* state_;
   Silice3D::BulletRigidBody* rbody_;
-  double activation_time_ = -1.0;
-
-  virtual void Update() override;
 
-  virtual void ReactToExplosion(const glm::dvec3& exp_position, double exp_radius) override;
+  // A dormant robot skips the update of itself and its components.
+  virtual void UpdateRecursive() override;
 };
 
 #endif
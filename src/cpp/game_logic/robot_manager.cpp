@@ -0,0 +1,20 @@
+// Copyright (c) Tamas Csala
+
+#include "game_logic/robot_manager.hpp"
+#include "game_logic/robot.hpp"
+
+btRigidBody* RobotManager::AddRobot(const RobotState* state, const glm::dvec3& pos) {
+  Silice3D::Transform robot_transform;
+  robot_transform.SetLocalPos(pos);
+  Robot* robot = AddComponent<Robot>(robot_transform, state);
+  robots_[state] = robot;
+  return robot->GetBtRigidBody();
+}
+
+void RobotManager::RemoveRobot(const RobotState* state) {
+  auto iter = robots_.find(state);
+  if (iter != robots_.end()) {
+    RemoveComponent(iter->second);
+    robots_.erase(iter);
+  }
+}
@@ -0,0 +1,27 @@
+// Copyright (c) Tamas Csala
+
+#ifndef ROBOT_MANAGER_HPP_
+#define ROBOT_MANAGER_HPP_
+
+#include <unordered_map>
+#include <Silice3D/core/game_object.hpp>
+
+#include "simulation/robot_swarm.hpp"
+
+class Robot;
+
+// The parent of the robots, it creates and removes them as the GameWorld
+// adds and removes their RobotStates.
+class RobotManager : public Silice3D::GameObject {
+ public:
+  using GameObject::GameObject;
+
+  // Returns the body of the new robot, for the RobotSwarm.
+  btRigidBody* AddRobot(const RobotState* state, const glm::dvec3& pos);
+  void RemoveRobot(const RobotState* state);
+
+ private:
+  std::unordered_map<const RobotState*, Robot*> robots_;
+};
+
+#endif
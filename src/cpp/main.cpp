@@ -1,12 +1,190 @@
 // Copyright (c) Tamas Csala
 
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+
 #include <Silice3D/core/game_engine.hpp>
 
+#include "./asset_manager.hpp"
 #include "./main_scene.hpp"
+#include "simulation/headless_simulation.hpp"
+#include "simulation/input_recording.hpp"
+#include "simulation/profiler.hpp"
+#include "settings.hpp"
+
+static void PrintUsage(const char* binary_name) {
+  std::cerr << "Usage: " << binary_name << " [options]" << std::endl
+            << "  --seed <n>          seed of the labyrinth and the gameplay" << std::endl
+            << "  --headless          run the simulation without a window" << std::endl
+            << "  --frames <n>        number of simulated frames (headless)" << std::endl
+            << "  --timestep <sec>    fixed timestep of a frame (headless)" << std::endl
+            << "  --threads <n>       particle update threads (headless, default: all cores)" << std::endl
+            << "  --complexity <name> very_low, low, medium, high, very_high, mega, ultra," << std::endl
+            << "                      wtf or gigantic (default: mega)" << std::endl
+            << "  --radius <n>        labyrinth radius, overrides the complexity" << std::endl
+            << "  --csv <file>        append the results as a CSV row (headless)" << std::endl
+            << "  --trace <file>      write the profiler's Chrome trace there at exit and" << std::endl
+            << "                      on F3 (needs a PYROMAZE_PROFILER build)" << std::endl
+            << "  --sweep <file>      run the headless simulation at every complexity, in" << std::endl
+            << "                      separate processes, and write the results as CSV" << std::endl
+            << "  --record <file>     record the input, the gameplay runs with the fixed" << std::endl
+            << "                      timestep" << std::endl
+            << "  --replay <file>     replay a recording (with --headless too) with its" << std::endl
+            << "                      seed, radius and timestep, then print the frame times" << std::endl;
+}
+
+// Runs every complexity in a new process of this binary, so that each gets
+// its own peak RSS measurement.
+static int RunComplexitySweep(const char* binary_name, const std::string& csv_path,
+                              uint64_t seed, const HeadlessOptions& options) {
+  {
+    std::ofstream csv{csv_path.c_str(), std::ios::trunc};
+    if (!csv) {
+      std::cerr << "Can't open " << csv_path << std::endl;
+      return 1;
+    }
+    HeadlessStats::WriteCsvHeader(csv);
+  }
+
+  for (Settings::SceneComplexity complexity : Settings::kSceneComplexities) {
+    const char* name = Settings::SceneComplexityName(complexity);
+    std::cout << "=== " << name << " ===" << std::endl;
+
+    std::ostringstream command;
+    command.precision(17);
+    command << '"' << binary_name << "\" --headless --complexity " << name
+            << " --seed " << seed << " --frames " << options.frame_count
+            << " --timestep " << options.timestep << " --threads " << options.thread_count
+            << " --csv \"" << csv_path << '"';
+    if (std::system(command.str().c_str()) != 0) {
+      std::cerr << "The " << name << " run failed" << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void WriteTrace(const std::string& path) {
+  if (path.empty()) {
+    return;
+  }
+  if (!Profiler::kEnabled) {
+    std::cerr << "Built without PYROMAZE_PROFILER, there is no trace to write" << std::endl;
+  } else if (!Profiler::Get().WriteChromeTrace(path)) {
+    std::cerr << "Can't write " << path << std::endl;
+  }
+}
 
 int main(const int argc, const char *argv[]) {
+  bool headless = false;
+  HeadlessOptions headless_options;
+  uint64_t seed = Settings::kDetermininistic ? 0 : time(nullptr);
+  Settings::SceneComplexity complexity = Settings::kSceneComplexity;
+  int labyrinth_radius = -1;
+  std::string csv_path, sweep_path, trace_path, record_path, replay_path;
+
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--seed") == 0 && i+1 < argc) {
+      seed = strtoull(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--headless") == 0) {
+      headless = true;
+    } else if (strcmp(argv[i], "--frames") == 0 && i+1 < argc) {
+      headless_options.frame_count = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--timestep") == 0 && i+1 < argc) {
+      headless_options.timestep = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc) {
+      headless_options.thread_count = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--complexity") == 0 && i+1 < argc &&
+               Settings::ParseSceneComplexity(argv[i+1], &complexity)) {
+      ++i;
+    } else if (strcmp(argv[i], "--radius") == 0 && i+1 < argc && atoi(argv[i+1]) > 0) {
+      labyrinth_radius = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--csv") == 0 && i+1 < argc) {
+      csv_path = argv[++i];
+    } else if (strcmp(argv[i], "--trace") == 0 && i+1 < argc) {
+      trace_path = argv[++i];
+      Profiler::Get().set_trace_path(trace_path);
+    } else if (strcmp(argv[i], "--sweep") == 0 && i+1 < argc) {
+      sweep_path = argv[++i];
+    } else if (strcmp(argv[i], "--record") == 0 && i+1 < argc) {
+      record_path = argv[++i];
+    } else if (strcmp(argv[i], "--replay") == 0 && i+1 < argc) {
+      replay_path = argv[++i];
+    } else {
+      PrintUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (!sweep_path.empty()) {
+    return RunComplexitySweep(argv[0], sweep_path, seed, headless_options);
+  }
+
+  const char* complexity_name = labyrinth_radius > 0 ? "custom"
+                                : Settings::SceneComplexityName(complexity);
+  if (labyrinth_radius <= 0) {
+    labyrinth_radius = Settings::LabyrinthRadius(complexity);
+  }
+
+  std::unique_ptr<InputRecording> replay;
+  if (!replay_path.empty()) {
+    replay.reset(new InputRecording{});
+    if (!replay->Read(replay_path)) {
+      std::cerr << "Can't read the recording " << replay_path << std::endl;
+      return 1;
+    }
+    seed = replay->seed;
+    labyrinth_radius = replay->labyrinth_radius;
+    headless_options.timestep = replay->timestep;
+  }
+
+  if (headless && !record_path.empty()) {
+    std::cerr << "There is no input to record in a headless run" << std::endl;
+    return 1;
+  }
+
+  if (headless) {
+    headless_options.seed = seed;
+    headless_options.labyrinth_radius = labyrinth_radius;
+    headless_options.replay = replay.get();
+    HeadlessSimulation simulation{headless_options};
+    HeadlessStats stats = simulation.Run();
+
+    if (!csv_path.empty()) {
+      bool is_new = !std::ifstream{csv_path.c_str()}.good();
+      std::ofstream csv{csv_path.c_str(), std::ios::app};
+      if (!csv) {
+        std::cerr << "Can't open " << csv_path << std::endl;
+        return 1;
+      }
+      if (is_new) {
+        HeadlessStats::WriteCsvHeader(csv);
+      }
+      stats.WriteCsvRow(csv, complexity_name);
+    }
+    WriteTrace(trace_path);
+    return 0;
+  }
+
   Silice3D::GameEngine engine("Pyromaze", Silice3D::GameEngine::WindowMode::kFullScreen);
-  engine.LoadScene(std::unique_ptr<Silice3D::Scene>{new MainScene{&engine}});
+  // The images are decoded while the scene is set up
+  std::unique_ptr<AssetManager> assets{new AssetManager{
+      {kSkyboxImage, kDiedScreenImage, kVictoryScreenImage, kDynamiteImage}}};
+  MainScene* scene = new MainScene{&engine, std::move(assets), seed, labyrinth_radius};
+  engine.LoadScene(std::unique_ptr<Silice3D::Scene>{scene});
+  if (replay) {
+    scene->StartReplay(std::move(replay));
+  } else if (!record_path.empty() &&
+             !scene->StartRecording(record_path, headless_options.timestep)) {
+    std::cerr << "Can't write " << record_path << std::endl;
+    return 1;
+  }
   engine.Run();
+  WriteTrace(trace_path);
 }
-
@@ -4,15 +4,20 @@
 #include "./settings.hpp"
 
 #include "environment/ground.hpp"
-#include "environment/wall.hpp"
+#include "environment/labyrinth_streamer.hpp"
 #include "environment/skybox.hpp"
-#include "environment/border_wall.hpp"
 
 #include "game_logic/fire.hpp"
 #include "game_logic/dynamite.hpp"
+#include "game_logic/dynamite_renderer.hpp"
 #include "game_logic/robot.hpp"
+#include "game_logic/robot_manager.hpp"
 #include "game_logic/player.hpp"
 
+#include "simulation/frame_time_summary.hpp"
+#include "simulation/profiler.hpp"
+
+#include <iostream>
 #include <Silice3D/core/game_engine.hpp>
 #include <Silice3D/common/make_unique.hpp>
 #include <Silice3D/camera/bullet_free_fly_camera.hpp>
@@ -21,28 +26,30 @@
 #include <Silice3D/debug/debug_shape.hpp>
 #include <Silice3D/debug/debug_texture.hpp>
 
-constexpr float kWallLength = 20;
-
-MainScene::MainScene(Silice3D::GameEngine* engine)
-    : Scene(engine) {
-  if (!Settings::kDetermininistic) {
-    srand(time(nullptr));
-  }
+static const glm::vec3 kPlayerStartPos{16, 3, 8};
+static const glm::vec3 kPlayerStartTarget{10, 3, 8};
 
+MainScene::MainScene(Silice3D::GameEngine* engine, std::unique_ptr<AssetManager> assets,
+                     uint64_t seed, int labyrinth_radius)
+    : MainSceneAssets(std::move(assets))
+    , Scene(engine)
+    , labyrinth_radius_(labyrinth_radius)
+    , particle_resources_(new ParticleResources{GetShaderManager()}) {
   // glfwSetInputMode(window(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
-  AddComponent<Skybox>("src/resource/skybox.png");
+  AddComponent<Skybox>(kSkyboxImage);
 
   // must be the first object after skybox
   AddComponent<Silice3D::MeshObjectBatchRenderer>();
+  dynamite_renderer_ = AddComponent<DynamiteRenderer>();
 
   cameras_ = AddComponent<Silice3D::GameObject>();
 
   player_camera_ = cameras_->AddComponent<Silice3D::BulletFreeFlyCamera>(
-      M_PI/3, 1, Settings::kLabyrinthDiameter*kWallLength, glm::vec3(16, 3, 8), glm::vec3(10, 3, 8), 16, 10);
+      M_PI/3, 1, Settings::LabyrinthDiameter(labyrinth_radius_)*kWallLength, kPlayerStartPos, kPlayerStartTarget, 16, 10);
   SetCamera(player_camera_);
 
-  Player* player = player_camera_->AddComponent<Player>();
+  player_camera_->AddComponent<Player>();
 
   // Shadows must be added after the cameras (update order!)
   const glm::vec3 lightPos = glm::normalize(glm::vec3{1.0});
@@ -68,11 +75,15 @@ MainScene::MainScene(Silice3D::GameEngine* engine)
     light_source->GetTransform().SetPos(lightPos);
   }
 
+  CreateLabyrinth(seed);
+  transient_objects_ = AddComponent<Silice3D::GameObject>();
+
   constexpr bool multi_point_light = false;
   if (multi_point_light) {
+    Random& random = GetRandom(RandomStream::kLights);
     for (int i = 0; i < 100; ++i) {
-      glm::vec3 color = glm::vec3{Silice3D::Math::Rand01()*0.5 + 0.5, Silice3D::Math::Rand01()*0.5 + 0.5, Silice3D::Math::Rand01()*0.5 + 0.5} * 5.0f;
-      glm::vec3 pos = glm::vec3{Silice3D::Math::Rand01() - 0.5f, 0, Silice3D::Math::Rand01() - 0.5f} * (Settings::kLabyrinthDiameter*kWallLength);
+      glm::vec3 color = glm::vec3{random.Rand01()*0.5 + 0.5, random.Rand01()*0.5 + 0.5, random.Rand01()*0.5 + 0.5} * 5.0f;
+      glm::vec3 pos = glm::vec3{random.Rand01() - 0.5f, 0, random.Rand01() - 0.5f} * (Settings::LabyrinthDiameter(labyrinth_radius_)*kWallLength);
       pos.y = kWallLength / 2.0;
       glm::vec3 attenuation = glm::vec3{0.2, 0.1, 0.1};
       Silice3D::PointLightSource* light_source = AddComponent<Silice3D::PointLightSource>(color, attenuation);
@@ -80,11 +91,23 @@ MainScene::MainScene(Silice3D::GameEngine* engine)
     }
   }
 
-  CreateLabyrinth(player);
+  // Upload the end screens now, not when the game ends (only the first
+  // scene does it, they are cached)
+  assets_->GetTexture(kDiedScreenImage);
+  assets_->GetTexture(kVictoryScreenImage);
 
   AddComponent<Silice3D::FpsDisplay>();
 }
 
+MainScene::~MainScene() {
+  if (!frame_times_.empty()) {
+    size_t tick_count = replay_ ? replay_tick_ : input_recorder_->tick_count();
+    std::cout << (replay_ ? "Replayed " : "Recorded ") << tick_count << " ticks"
+              << " (dt = " << fixed_timestep_ << " s)" << std::endl;
+    FrameTimeSummary::Compute(frame_times_).Print(std::cout);
+  }
+}
+
 class NoUpdateGameObject : public Silice3D::GameObject {
 public:
   using GameObject::GameObject;
@@ -94,57 +117,215 @@ public:
   }
 };
 
-void MainScene::CreateLabyrinth(Player* player) {
+void MainScene::CreateLabyrinth(uint64_t seed) {
   auto envir = AddComponent<GameObject>();
 
-  envir->AddComponent<Ground>();
-
-  for (int x = -Settings::kLabyrinthRadius; x <= Settings::kLabyrinthRadius; ++x) {
-    for (int z = -Settings::kLabyrinthRadius; z <= Settings::kLabyrinthRadius; ++z) {
-      Silice3D::Transform wall_transform;
-      wall_transform.SetLocalPos({x * kWallLength, -0.5, z * kWallLength});
-      envir->AddComponent<Wall>(wall_transform);
-
-      if ((abs(x) > 1 || abs(z) > 1) && x != Settings::kLabyrinthRadius
-          && z != Settings::kLabyrinthRadius && rand()%2 == 0) {
-        Silice3D::Transform robot_transform;
-        robot_transform.SetLocalPos({x * kWallLength + kWallLength/2.0, 3,
-                                       z * kWallLength + kWallLength/2.0});
-        envir->AddComponent<Robot>(robot_transform, player);
-      }
-    }
+  envir->AddComponent<Ground>(labyrinth_radius_);
+  robots_ = envir->AddComponent<RobotManager>();
+  labyrinth_streamer_ = envir->AddComponent<LabyrinthStreamer>(labyrinth_radius_);
+
+  // Loads the chunks around the player, through the objects above
+  world_.reset(new GameWorld{seed, labyrinth_radius_, glm::dvec3(kPlayerStartPos),
+                             true, this});
+}
+
+void MainScene::Restart() {
+  Reset(GetSeed() + 1);
+}
+
+void MainScene::Reset(uint64_t seed) {
+  // Called from the updates (explosions, key presses), where the objects
+  // can't be replaced yet
+  reset_pending_ = true;
+  reset_seed_ = seed;
+}
+
+void MainScene::PerformReset() {
+  PYROMAZE_PROFILE_ZONE("MainScene::PerformReset");
+  reset_pending_ = false;
+
+  // The dynamites are removed with their parent, the world's removals of
+  // them are ignored
+  RemoveComponent(transient_objects_);
+  transient_objects_ = AddComponent<Silice3D::GameObject>();
+  dynamites_.clear();
+
+  player_camera_->GetTransform().SetPos(kPlayerStartPos);
+  player_camera_->GetTransform().SetForward(kPlayerStartTarget - kPlayerStartPos);
+  world_->Reset(reset_seed_, glm::dvec3(kPlayerStartPos));
+}
+
+bool MainScene::StartRecording(const std::string& path, double timestep) {
+  input_recorder_.reset(new InputRecorder{});
+  if (!input_recorder_->Open(path, GetSeed(), labyrinth_radius_, timestep)) {
+    input_recorder_ = nullptr;
+    return false;
   }
+  fixed_timestep_ = timestep;
+  return true;
+}
 
-  constexpr int kBorderRadius = Settings::kLabyrinthRadius+1;
-  for (int z = -kBorderRadius; z <= kBorderRadius; z += 2*kBorderRadius) {
-    for (int x = -kBorderRadius; x <= kBorderRadius; ++x) {
-      Silice3D::Transform wall_transform;
-      wall_transform.SetLocalPos({x * kWallLength, -0.5, z * kWallLength});
-      envir->AddComponent<BorderWall>("wall/bigwall1.obj", wall_transform);
-    }
+void MainScene::StartReplay(std::unique_ptr<InputRecording> recording) {
+  fixed_timestep_ = recording->timestep;
+  replay_ = std::move(recording);
+}
+
+double MainScene::GetGameplayTime() {
+  return fixed_timestep_ > 0.0 ? fixed_time_ : GetGameTime().GetCurrentTime();
+}
+
+double MainScene::GetGameplayDeltaTime() {
+  return fixed_timestep_ > 0.0 ? fixed_delta_time_ : GetGameTime().GetDeltaTime();
+}
+
+void MainScene::SetPlayerCamera(const glm::dvec3& pos, const glm::dvec3& forward) {
+  player_camera_->GetTransform().SetPos(pos);
+  player_camera_->GetTransform().SetForward(forward);
+}
+
+void MainScene::RecordInput() {
+  input_recorder_->WriteTick(player_camera_->GetTransform().GetPos(),
+                             player_camera_->GetTransform().GetForward());
+}
+
+void MainScene::ReplayInput() {
+  if (replay_tick_ == replay_->ticks.size()) {
+    glfwSetWindowShouldClose(GetWindow(), GL_TRUE);
+    return;
   }
 
-  for (int x = -kBorderRadius; x <= kBorderRadius; x += 2*kBorderRadius) {
-    for (int z = -kBorderRadius; z <= kBorderRadius; ++z) {
-      Silice3D::Transform wall_transform;
-      wall_transform.SetLocalPos({x * kWallLength, -0.5, z * kWallLength});
-      envir->AddComponent<BorderWall>("wall/bigwall2.obj", wall_transform);
+  // The events are handled as if they arrived before this frame
+  const InputTick& tick = replay_->ticks[replay_tick_++];
+  SetPlayerCamera(tick.camera_pos, tick.camera_forward);
+  for (const InputEvent& event : tick.events) {
+    Scene::KeyActionRecursive(event.key, event.scancode, event.action, event.mods);
+  }
+}
+
+void MainScene::UpdateRecursive() {
+  PYROMAZE_PROFILE_FRAME();
+  PYROMAZE_PROFILE_ZONE("MainScene::UpdateRecursive");
+  if (fixed_timestep_ > 0.0) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point frame_start = Clock::now();
+    // The first frame's time is the loading
+    if (last_frame_start_ != Clock::time_point{}) {
+      frame_times_.push_back(std::chrono::duration<double>(frame_start - last_frame_start_).count());
     }
+    last_frame_start_ = frame_start;
+
+    fixed_delta_time_ = frozen_ ? 0.0 : fixed_timestep_;
+    fixed_time_ += fixed_delta_time_;
   }
+
+  if (input_recorder_) {
+    RecordInput();
+  } else if (replay_) {
+    ReplayInput();
+  }
+  if (reset_pending_) {
+    PerformReset();
+  }
+  world_->Update(GetGameplayTime(), player_camera_->GetTransform().GetPos());
+  Scene::UpdateRecursive();
+
+  if (input_recorder_) {
+    // The key events until the next frame see the camera as it's recorded
+    SetPlayerCamera(RecordedVector(player_camera_->GetTransform().GetPos()),
+                    RecordedVector(player_camera_->GetTransform().GetForward()));
+  }
+}
+
+void MainScene::ShowEndScreen(const char* image) {
+  Silice3D::DebugTexture{GetShaderManager()}.Render(assets_->GetTexture(image));
+  glfwSwapBuffers(GetWindow());
+}
+
+void MainScene::OnChunkLoaded(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls,
+                              std::unique_ptr<btCompoundShape> collision_shape) {
+  labyrinth_streamer_->AddChunk(chunk, walls, std::move(collision_shape));
+}
+
+void MainScene::OnChunkWallsReset(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls) {
+  labyrinth_streamer_->ResetChunk(chunk, walls);
+}
+
+void MainScene::OnWallPartsRemoved(LabyrinthChunkCoord chunk,
+                                   const std::vector<WallPartHit>& parts) {
+  labyrinth_streamer_->RemoveWallParts(chunk, parts);
+}
+
+void MainScene::OnChunkUnloaded(LabyrinthChunkCoord chunk) {
+  labyrinth_streamer_->RemoveChunk(chunk);
+}
+
+btRigidBody* MainScene::OnRobotAdded(RobotState* robot, const glm::dvec3& pos) {
+  return robots_->AddRobot(robot, pos);
+}
+
+void MainScene::OnRobotRemoved(RobotState* robot) {
+  robots_->RemoveRobot(robot);
+}
+
+void MainScene::OnDynamiteAdded(DynamiteState* dynamite) {
+  Silice3D::Transform dynamite_trafo;
+  dynamite_trafo.SetPos(dynamite->pos);
+  dynamites_[dynamite] = transient_objects_->AddComponent<Dynamite>(dynamite_trafo, dynamite);
+}
+
+void MainScene::OnDynamiteRemoved(DynamiteState* dynamite) {
+  auto iter = dynamites_.find(dynamite);
+  if (iter != dynamites_.end()) {
+    transient_objects_->RemoveComponent(iter->second);
+    dynamites_.erase(iter);
+  }
+}
+
+void MainScene::OnBlast(const Blast& blast) {
+  Explosion* explosion = transient_objects_->AddComponent<Explosion>(blast.ParticleBudget());
+  explosion->GetTransform().SetLocalPos(blast.center);
+}
+
+void MainScene::OnPlayerHit() {
+  ShowEndScreen(kDiedScreenImage);
+  Restart();
+}
+
+void MainScene::OnBorderWallHit() {
+  ShowEndScreen(kVictoryScreenImage);
+  Restart();
+}
+
+void MainScene::KeyActionRecursive(int key, int scancode, int action, int mods) {
+  if (replay_) {
+    return;
+  }
+  if (input_recorder_) {
+    input_recorder_->RecordKey(key, scancode, action, mods);
+  }
+  Scene::KeyActionRecursive(key, scancode, action, mods);
 }
 
 void MainScene::KeyAction(int key, int scancode, int action, int mods) {
   if (action == GLFW_PRESS && key == GLFW_KEY_F2) {
-    GetEngine()->LoadScene(std::unique_ptr<Silice3D::Scene>{new MainScene{GetEngine()}});
+    Restart();
+  } else if (action == GLFW_PRESS && key == GLFW_KEY_F4) {
+    // The same labyrinth again
+    Reset(GetSeed());
+  } else if (action == GLFW_PRESS && key == GLFW_KEY_F3) {
+    if (!Profiler::kEnabled) {
+      std::cerr << "Built without PYROMAZE_PROFILER, there is no trace to write" << std::endl;
+    } else if (Profiler::Get().WriteChromeTrace(Profiler::Get().trace_path())) {
+      std::cout << "Trace written to " << Profiler::Get().trace_path() << std::endl;
+    }
   } else if (action == GLFW_PRESS && key == GLFW_KEY_TAB) {
-    static bool frozen = false;
-    frozen = !frozen;
+    frozen_ = !frozen_;
 
-    if (frozen) {
+    if (frozen_) {
       // freeze the scene now
       GetGameTime().Stop();
       Silice3D::ICamera* free_fly_cam = cameras_->AddComponent<Silice3D::FreeFlyCamera>(
-        M_PI/3, 1, Settings::kLabyrinthDiameter*kWallLength,
+        M_PI/3, 1, Settings::LabyrinthDiameter(labyrinth_radius_)*kWallLength,
         player_camera_->GetTransform().GetPos(),
         player_camera_->GetTransform().GetPos() + player_camera_->GetTransform().GetForward(),
         16, 10);
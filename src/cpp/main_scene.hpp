@@ -5,19 +5,132 @@
 
 #include <Silice3D/core/scene.hpp>
 
-class Player;
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
-class MainScene : public Silice3D::Scene {
+#include "./asset_manager.hpp"
+#include "game_logic/particle_resources.hpp"
+#include "simulation/game_world.hpp"
+#include "simulation/input_recording.hpp"
+
+class Dynamite;
+class DynamiteRenderer;
+class LabyrinthStreamer;
+class RobotManager;
+
+// The assets of MainScene. It's a base class declared before Silice3D::Scene,
+// so the assets are destroyed after the scene's objects that use them.
+class MainSceneAssets {
+ protected:
+  explicit MainSceneAssets(std::unique_ptr<AssetManager> assets)
+      : assets_(std::move(assets)) {}
+
+  std::unique_ptr<AssetManager> assets_;
+};
+
+// Runs the game through a GameWorld, and shows it with the scene objects it
+// creates as the world tells it.
+class MainScene : private MainSceneAssets, public Silice3D::Scene,
+                  private GameWorldListener {
  public:
-  MainScene(Silice3D::GameEngine* engine);
+  // The assets are shared by the resets, and destroyed with the scene, which
+  // the engine destroys while its OpenGL context is still alive.
+  MainScene(Silice3D::GameEngine* engine, std::unique_ptr<AssetManager> assets,
+            uint64_t seed, int labyrinth_radius);
+  ~MainScene();
+
+  uint64_t GetSeed() const { return world_->seed(); }
+  int GetLabyrinthRadius() const { return labyrinth_radius_; }
+  Random& GetRandom(RandomStream stream) { return world_->GetRandom(stream); }
+  GameWorld* GetWorld() { return world_.get(); }
+
+  // Starts a new game, with a new labyrinth.
+  void Restart();
+  // Starts a new game with the labyrinth of the seed, at the start of the
+  // next frame. The scene is reset in place: the meshes, shaders, textures
+  // and shadow maps are kept, and the chunks around the player are reused.
+  void Reset(uint64_t seed);
+
+  // Records the input of every frame from now on. The gameplay runs with the
+  // fixed timestep, so that the replays are the same.
+  bool StartRecording(const std::string& path, double timestep);
+  // Plays back a recording (made with this seed and radius) instead of the
+  // input, one tick per frame, then closes the window. The frame times are
+  // printed at the end.
+  void StartReplay(std::unique_ptr<InputRecording> recording);
+
+  // The clock of the gameplay: the game time, or the fixed timestep ticks
+  // while recording or replaying.
+  double GetGameplayTime();
+  double GetGameplayDeltaTime();
+
+  AssetManager* GetAssets() { return assets_.get(); }
+  // The parent of the dynamites and explosions, they are removed by a reset.
+  Silice3D::GameObject* GetTransientObjects() { return transient_objects_; }
+  ParticleResources* GetParticleResources() { return particle_resources_.get(); }
+  DynamiteRenderer* GetDynamiteRenderer() { return dynamite_renderer_; }
 
  private:
+  int labyrinth_radius_;
+  std::unique_ptr<ParticleResources> particle_resources_;
+  DynamiteRenderer* dynamite_renderer_ = nullptr;
+  LabyrinthStreamer* labyrinth_streamer_ = nullptr;
+  RobotManager* robots_ = nullptr;
+  Silice3D::GameObject* transient_objects_ = nullptr;
+  std::unordered_map<const DynamiteState*, Dynamite*> dynamites_;
   Silice3D::GameObject* cameras_;
   Silice3D::ICamera* player_camera_;
+  bool reset_pending_ = false;
+  uint64_t reset_seed_ = 0;
+  bool frozen_ = false;
+
+  // Recording and replay, see StartRecording and StartReplay
+  std::unique_ptr<InputRecorder> input_recorder_;
+  std::unique_ptr<InputRecording> replay_;
+  size_t replay_tick_ = 0;
+  double fixed_timestep_ = 0.0;
+  double fixed_time_ = 0.0;
+  double fixed_delta_time_ = 0.0;
+  std::chrono::steady_clock::time_point last_frame_start_;
+  std::vector<double> frame_times_;
+
+  // After the scene objects that it notifies
+  std::unique_ptr<GameWorld> world_;
+
+  void CreateLabyrinth(uint64_t seed);
+  void PerformReset();
+  // Records or replays the input of a tick, at the start of the frame.
+  void RecordInput();
+  void ReplayInput();
+  void SetPlayerCamera(const glm::dvec3& pos, const glm::dvec3& forward);
+  void ShowEndScreen(const char* image);
 
-  void CreateLabyrinth(Player* player);
+  virtual void OnChunkLoaded(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls,
+                             std::unique_ptr<btCompoundShape> collision_shape) override;
+  virtual void OnChunkWallsReset(LabyrinthChunkCoord chunk,
+                                 const LabyrinthChunkWalls& walls) override;
+  virtual void OnWallPartsRemoved(LabyrinthChunkCoord chunk,
+                                  const std::vector<WallPartHit>& parts) override;
+  virtual void OnChunkUnloaded(LabyrinthChunkCoord chunk) override;
+  virtual btRigidBody* OnRobotAdded(RobotState* robot, const glm::dvec3& pos) override;
+  virtual void OnRobotRemoved(RobotState* robot) override;
+  virtual void OnDynamiteAdded(DynamiteState* dynamite) override;
+  virtual void OnDynamiteRemoved(DynamiteState* dynamite) override;
+  // Creates the explosion
+  virtual void OnBlast(const Blast& blast) override;
+  // The died and victory screens, then a new game
+  virtual void OnPlayerHit() override;
+  virtual void OnBorderWallHit() override;
 
+  // The start of a frame, the safe point of the reset
+  virtual void UpdateRecursive() override;
   virtual void KeyAction(int key, int scancode, int action, int mods) override;
+  // Records the live input, or ignores it during a replay.
+  virtual void KeyActionRecursive(int key, int scancode, int action, int mods) override;
 };
 
 #endif
@@ -3,28 +3,71 @@
 #ifndef SETTINGS_HPP_
 #define SETTINGS_HPP_
 
+#include <cstring>
+
 // ========================= SceneComplexity settings =========================
 
 namespace Settings {
 
 enum class SceneComplexity {
-  kVeryLow, kLow, kMedium, kHigh, kVeryHigh, kMega, kUltra, kWtf
+  kVeryLow, kLow, kMedium, kHigh, kVeryHigh, kMega, kUltra, kWtf, kGigantic
+};
+
+constexpr SceneComplexity kSceneComplexities[] = {
+  SceneComplexity::kVeryLow, SceneComplexity::kLow, SceneComplexity::kMedium,
+  SceneComplexity::kHigh, SceneComplexity::kVeryHigh, SceneComplexity::kMega,
+  SceneComplexity::kUltra, SceneComplexity::kWtf, SceneComplexity::kGigantic
 };
 
+// The default, can be overridden with --complexity or --radius
 constexpr SceneComplexity kSceneComplexity = SceneComplexity::kMega;
 
-constexpr int kLabyrinthRadius =
-  kSceneComplexity == SceneComplexity::kVeryLow  ? 3 :
-  kSceneComplexity == SceneComplexity::kLow      ? 5 :
-  kSceneComplexity == SceneComplexity::kMedium   ? 8 :
-  kSceneComplexity == SceneComplexity::kHigh     ? 12 :
-  kSceneComplexity == SceneComplexity::kVeryHigh ? 16 :
-  kSceneComplexity == SceneComplexity::kMega     ? 32 :
-  kSceneComplexity == SceneComplexity::kUltra    ? 48 :
-  /*kSceneComplexity == SceneComplexity::kWtf*/    64;
+constexpr int LabyrinthRadius(SceneComplexity complexity) {
+  return
+    complexity == SceneComplexity::kVeryLow  ? 3 :
+    complexity == SceneComplexity::kLow      ? 5 :
+    complexity == SceneComplexity::kMedium   ? 8 :
+    complexity == SceneComplexity::kHigh     ? 12 :
+    complexity == SceneComplexity::kVeryHigh ? 16 :
+    complexity == SceneComplexity::kMega     ? 32 :
+    complexity == SceneComplexity::kUltra    ? 48 :
+    complexity == SceneComplexity::kWtf      ? 64 :
+    /*complexity == SceneComplexity::kGigantic*/ 256;
+}
+
+constexpr int LabyrinthDiameter(int labyrinth_radius) {
+  return 2*(labyrinth_radius + 1/*border*/) + 1/*center*/;
+}
+
+constexpr int kLabyrinthRadius = LabyrinthRadius(kSceneComplexity);
 
-constexpr int kLabyrinthDiameter = 2*(kLabyrinthRadius + 1/*border*/) + 1/*center*/;
+inline const char* SceneComplexityName(SceneComplexity complexity) {
+  switch (complexity) {
+    case SceneComplexity::kVeryLow: return "very_low";
+    case SceneComplexity::kLow: return "low";
+    case SceneComplexity::kMedium: return "medium";
+    case SceneComplexity::kHigh: return "high";
+    case SceneComplexity::kVeryHigh: return "very_high";
+    case SceneComplexity::kMega: return "mega";
+    case SceneComplexity::kUltra: return "ultra";
+    case SceneComplexity::kWtf: return "wtf";
+    case SceneComplexity::kGigantic: return "gigantic";
+  }
+  return "";
+}
+
+// Returns false if the name isn't one of SceneComplexityName's.
+inline bool ParseSceneComplexity(const char* name, SceneComplexity* complexity) {
+  for (SceneComplexity candidate : kSceneComplexities) {
+    if (strcmp(name, SceneComplexityName(candidate)) == 0) {
+      *complexity = candidate;
+      return true;
+    }
+  }
+  return false;
+}
 
+// Use a fixed default seed instead of a time based one
 constexpr bool kDetermininistic = true;
 
 }
@@ -0,0 +1,96 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+#include "simulation/detonation_queue.hpp"
+#include "simulation/spatial_grid.hpp"
+
+bool Blast::HitsWallPart(const glm::dvec3& part_center) const {
+  for (const glm::dvec3& exp_position : centers) {
+    if (GameRules::IsWallPartHit(exp_position, radius, part_center)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Blast::HitsActor(const glm::dvec3& actor_pos) const {
+  for (const glm::dvec3& exp_position : centers) {
+    if (GameRules::IsActorHit(exp_position, radius, actor_pos)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Blast::HitsBorderWall(const glm::dvec3& wall_pos) const {
+  for (const glm::dvec3& exp_position : centers) {
+    if (GameRules::IsBorderWallHit(exp_position, radius, wall_pos)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static size_t FindRoot(std::vector<size_t>& parents, size_t i) {
+  while (parents[i] != i) {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+  }
+  return i;
+}
+
+std::vector<Blast> DetonationQueue::TakeBlasts() {
+  std::vector<Blast> blasts;
+  if (pending_.empty()) {
+    return blasts;
+  }
+
+  // Two blasts overlap if their centers are closer than twice the radius,
+  // with cells of that size only the neighbouring cells have to be checked.
+  const double merge_distance = 2 * GameRules::kExplosionRadius;
+  SpatialGrid<const glm::dvec3> grid{merge_distance};
+  std::vector<size_t> parents(pending_.size());
+  std::iota(parents.begin(), parents.end(), 0);
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    GridCell cell = grid.GetCell(pending_[i]);
+    for (int x = cell.x - 1; x <= cell.x + 1; ++x) {
+      for (int z = cell.z - 1; z <= cell.z + 1; ++z) {
+        grid.ForEachInCell(GridCell(x, z), [&](const glm::dvec3* other) {
+          if (glm::length(*other - pending_[i]) < merge_distance) {
+            parents[FindRoot(parents, other - pending_.data())] = FindRoot(parents, i);
+          }
+        });
+      }
+    }
+    grid.Insert(&pending_[i], cell);
+  }
+
+  std::unordered_map<size_t, size_t> blast_indices;
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    size_t root = FindRoot(parents, i);
+    auto iter = blast_indices.find(root);
+    if (iter == blast_indices.end()) {
+      iter = blast_indices.insert(std::make_pair(root, blasts.size())).first;
+      blasts.emplace_back();
+    }
+    blasts[iter->second].centers.push_back(pending_[i]);
+  }
+
+  for (Blast& blast : blasts) {
+    glm::dvec3 sum{0.0};
+    for (const glm::dvec3& center : blast.centers) {
+      sum += center;
+    }
+    blast.center = sum / double(blast.centers.size());
+    for (const glm::dvec3& center : blast.centers) {
+      blast.centers_radius = std::max(blast.centers_radius, glm::length(center - blast.center));
+    }
+  }
+
+  pending_.clear();
+  return blasts;
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_DETONATION_QUEUE_HPP_
+#define SIMULATION_DETONATION_QUEUE_HPP_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "simulation/game_rules.hpp"
+
+// The blast of one or more detonations of the same frame, that overlap. It is
+// resolved with one query (of the circle that contains every object that
+// might be hit), and it has one explosion effect with a shared particle
+// budget. An object is hit if any of the detonations hits it.
+struct Blast {
+  Blast() = default;
+  // A single detonation
+  explicit Blast(const glm::dvec3& pos) : centers{pos}, center(pos) {}
+
+  std::vector<glm::dvec3> centers;
+  double radius = GameRules::kExplosionRadius;
+  // The circle that encloses the centers
+  glm::dvec3 center;
+  double centers_radius = 0.0;
+
+  double QueryRadius() const {
+    return centers_radius + GameRules::ExplosionQueryRadius(radius);
+  }
+
+  bool HitsWallPart(const glm::dvec3& part_center) const;
+  bool HitsActor(const glm::dvec3& actor_pos) const;
+  bool HitsBorderWall(const glm::dvec3& wall_pos) const;
+
+  int ParticleBudget() const {
+    return GameRules::ExplosionParticleBudget(centers.size());
+  }
+};
+
+// The detonations are pushed during a frame (by the dynamites that burnt
+// down, and by the objects that a blast set off), and resolved in one batch
+// at the start of the next frame. So a chain reaction advances a step per
+// frame, instead of nested reactions that spawn explosions while the
+// robots and dynamites are enumerated.
+class DetonationQueue {
+ public:
+  bool empty() const { return pending_.empty(); }
+  size_t size() const { return pending_.size(); }
+
+  void Push(const glm::dvec3& pos) { pending_.push_back(pos); }
+  void Clear() { pending_.clear(); }
+
+  // Removes the pending detonations, merged into blasts: the detonations
+  // whose blasts overlap (directly or through others) form one blast.
+  std::vector<Blast> TakeBlasts();
+
+ private:
+  std::vector<glm::dvec3> pending_;
+};
+
+#endif
@@ -0,0 +1,56 @@
+// Copyright (c) Tamas Csala
+
+#include <utility>
+
+#include "simulation/dynamite_fuse.hpp"
+
+namespace {
+
+constexpr size_t kNumPositions = 6;
+
+// The points of the fuse, with the phase when the fire reaches them.
+struct FusePath {
+  std::pair<float, glm::vec3> positions[kNumPositions] = {
+    {0, {0.52, 1.6, 0.05}},
+    {0, {0.3, 1.72, 0.05}},
+    {0, {0.15, 1.68, 0.05}},
+    {0, {0.1, 1.62, 0.05}},
+    {0, {0.01, 1.4, 0.05}},
+    {0, {0.01, 1.18, 0.05}}
+  };
+
+  FusePath() {
+    // make it burn with unit speed
+    float sumDist = 0.0;
+    for (unsigned i = 0; i < kNumPositions - 1; ++i) {
+      auto& a = positions[i];
+      auto& b = positions[i+1];
+      sumDist += length(a.second - b.second);
+    }
+    float cumulativeDist = 0.0;
+    for (unsigned i = 0; i < kNumPositions - 1; ++i) {
+      auto& a = positions[i];
+      auto& b = positions[i+1];
+      cumulativeDist += length(a.second - b.second);
+      b.first = cumulativeDist / sumDist;
+    }
+  }
+};
+
+}  // namespace
+
+glm::vec3 FusePosition(double phase) {
+  static const FusePath path;
+  const auto& positions = path.positions;
+
+  for (unsigned i = 0; i < kNumPositions - 1; ++i) {
+    if (phase < positions[i+1].first) {
+      auto& a = positions[i];
+      auto& b = positions[i+1];
+      return glm::mix(a.second, b.second,
+                      float((phase-a.first)/(b.first-a.first)));
+    }
+  }
+
+  return positions[kNumPositions - 1].second;
+}
@@ -0,0 +1,12 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_DYNAMITE_FUSE_HPP_
+#define SIMULATION_DYNAMITE_FUSE_HPP_
+
+#include <glm/glm.hpp>
+
+// The position of the burning end of the fuse (in the dynamite's model space)
+// at a given phase of the burning (0 = just lit, 1 = exploding).
+glm::vec3 FusePosition(double phase);
+
+#endif
@@ -0,0 +1,60 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+
+#include "simulation/explosion_damage.hpp"
+#include "simulation/game_rules.hpp"
+
+void FindWallPartsHit(const LabyrinthGrid& grid, const LabyrinthCollision& collision,
+                      const Blast& blast, std::vector<WallPartHit>* hits) {
+  // Around each center, as the circle that encloses the centers of a merged
+  // chain would cover a lot more junctions than the detonations themselves
+  size_t first_hit = hits->size();
+  double query_radius = GameRules::ExplosionQueryRadius(blast.radius);
+  for (const glm::dvec3& exp_position : blast.centers) {
+    grid.ForEachJunctionInRadius(exp_position, query_radius, [&](int x, int z) {
+      uint8_t wall_parts = grid.GetWallParts(x, z);
+      if (wall_parts == 0) {
+        return;
+      }
+      glm::vec3 junction_pos = LabyrinthGrid::GetJunctionPos(x, z);
+      for (int i = 0; i < 4; ++i) {
+        glm::vec3 part_center = junction_pos + collision.GetWallPartCenter(i);
+        if (((wall_parts >> i) & 1) &&
+            GameRules::IsWallPartHit(exp_position, blast.radius, glm::dvec3(part_center))) {
+          hits->push_back(WallPartHit{x, z, i});
+        }
+      }
+    });
+  }
+
+  // The parts hit by more than one of the centers
+  if (blast.centers.size() > 1) {
+    auto less = [](const WallPartHit& a, const WallPartHit& b) {
+      return a.x != b.x ? a.x < b.x : a.z != b.z ? a.z < b.z : a.part < b.part;
+    };
+    auto equal = [](const WallPartHit& a, const WallPartHit& b) {
+      return a.x == b.x && a.z == b.z && a.part == b.part;
+    };
+    std::sort(hits->begin() + first_hit, hits->end(), less);
+    hits->erase(std::unique(hits->begin() + first_hit, hits->end(), equal), hits->end());
+  }
+}
+
+std::vector<LabyrinthChunkCoord> DestroyWallParts(const std::vector<WallPartHit>& hits,
+                                                  LabyrinthGrid* grid, FlowField* flow_field) {
+  std::vector<LabyrinthChunkCoord> chunks;
+  for (const WallPartHit& hit : hits) {
+    if (!grid->RemoveWallPart(hit.x, hit.z, hit.part)) {
+      continue;
+    }
+    flow_field->OnWallPartRemoved(hit.x, hit.z, hit.part);
+
+    // An explosion touches a few chunks at most
+    LabyrinthChunkCoord chunk = LabyrinthChunkCoord::FromJunction(hit.x, hit.z);
+    if (std::find(chunks.begin(), chunks.end(), chunk) == chunks.end()) {
+      chunks.push_back(chunk);
+    }
+  }
+  return chunks;
+}
@@ -0,0 +1,33 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_EXPLOSION_DAMAGE_HPP_
+#define SIMULATION_EXPLOSION_DAMAGE_HPP_
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "simulation/detonation_queue.hpp"
+#include "simulation/flow_field.hpp"
+#include "simulation/labyrinth_collision.hpp"
+#include "simulation/labyrinth_grid.hpp"
+
+// A blast is resolved once, when it detonates: the wall parts it hits are
+// gathered from the junctions around it, and destroyed in one batch, so every
+// touched chunk is rebuilt only once, even if the blast merges several
+// detonations. Used by both the scene
+// graph objects and the headless simulation.
+
+struct WallPartHit {
+  int x, z, part;
+};
+
+// Appends the standing wall parts hit by the blast.
+void FindWallPartsHit(const LabyrinthGrid& grid, const LabyrinthCollision& collision,
+                      const Blast& blast, std::vector<WallPartHit>* hits);
+
+// Removes the parts from the grid and the flow field, and returns the chunks
+// that contain them, each of them once.
+std::vector<LabyrinthChunkCoord> DestroyWallParts(const std::vector<WallPartHit>& hits,
+                                                  LabyrinthGrid* grid, FlowField* flow_field);
+
+#endif
@@ -0,0 +1,206 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "simulation/flow_field.hpp"
+
+constexpr int FlowField::kDefaultWindowRadius;
+constexpr uint32_t FlowField::kUnreachable;
+
+FlowField::FlowField(const LabyrinthGrid& grid, int window_radius)
+    : grid_(grid)
+    , radius_(grid.radius())
+    , window_radius_(window_radius)
+    , room_count_per_side_(2*window_radius + 1)
+    , distance_(room_count_per_side_ * room_count_per_side_, kUnreachable)
+    , next_(room_count_per_side_ * room_count_per_side_, kNone) {
+}
+
+LabyrinthRoom FlowField::GetRoom(const glm::dvec3& pos) {
+  return LabyrinthRoom{static_cast<int>(std::floor(pos.x / kWallLength)),
+                       static_cast<int>(std::floor(pos.z / kWallLength))};
+}
+
+// Inside the labyrinth (including the rooms next to the border walls) and
+// inside the window around the target.
+bool FlowField::IsValid(LabyrinthRoom room) const {
+  return has_target_ &&
+         -radius_ - 1 <= room.x && room.x <= radius_ &&
+         -radius_ - 1 <= room.z && room.z <= radius_ &&
+         std::abs(room.x - target_.x) <= window_radius_ &&
+         std::abs(room.z - target_.z) <= window_radius_;
+}
+
+int FlowField::RoomIndex(LabyrinthRoom room) const {
+  return (room.x - target_.x + window_radius_) * room_count_per_side_ +
+         (room.z - target_.z + window_radius_);
+}
+
+LabyrinthRoom FlowField::RoomAt(int index) const {
+  return LabyrinthRoom{index / room_count_per_side_ - window_radius_ + target_.x,
+                       index % room_count_per_side_ - window_radius_ + target_.z};
+}
+
+// The edge between two junctions is covered by two wall parts, one from each
+// junction, the passage is open if any of them is missing.
+bool FlowField::IsPassageOpen(LabyrinthRoom room, Direction dir) const {
+  if (!IsValid(Neighbour(room, dir))) {
+    return false;
+  }
+
+  int x = room.x, z = room.z;
+  switch (dir) {
+    case kNegX: return !HasWallPart(x, z, 0) || !HasWallPart(x, z+1, 2);
+    case kPosX: return !HasWallPart(x+1, z, 0) || !HasWallPart(x+1, z+1, 2);
+    case kNegZ: return !HasWallPart(x, z, 3) || !HasWallPart(x+1, z, 1);
+    case kPosZ: return !HasWallPart(x, z+1, 3) || !HasWallPart(x+1, z+1, 1);
+    default: return false;
+  }
+}
+
+LabyrinthRoom FlowField::Neighbour(LabyrinthRoom room, Direction dir) {
+  switch (dir) {
+    case kPosX: return LabyrinthRoom{room.x + 1, room.z};
+    case kNegX: return LabyrinthRoom{room.x - 1, room.z};
+    case kPosZ: return LabyrinthRoom{room.x, room.z + 1};
+    case kNegZ: return LabyrinthRoom{room.x, room.z - 1};
+    default: return room;
+  }
+}
+
+FlowField::Direction FlowField::Opposite(Direction dir) {
+  switch (dir) {
+    case kPosX: return kNegX;
+    case kNegX: return kPosX;
+    case kPosZ: return kNegZ;
+    case kNegZ: return kPosZ;
+    default: return kNone;
+  }
+}
+
+void FlowField::SetTarget(const glm::dvec3& pos) {
+  LabyrinthRoom target = GetRoom(pos);
+  if (has_target_ && target == target_) {
+    return;
+  }
+  target_ = target;
+  has_target_ = true;
+  Rebuild();
+}
+
+void FlowField::Rebuild() {
+  std::fill(distance_.begin(), distance_.end(), kUnreachable);
+  std::fill(next_.begin(), next_.end(), kNone);
+  queue_.clear();
+  if (IsValid(target_)) {
+    distance_[RoomIndex(target_)] = 0;
+    queue_.push_back(RoomIndex(target_));
+  }
+  Relax();
+}
+
+void FlowField::Relax() {
+  // Every edge has the same length, so a FIFO processes the rooms in the
+  // order of their distance, and each of them is finalized when popped.
+  for (size_t i = 0; i < queue_.size(); ++i) {
+    int index = queue_[i];
+    LabyrinthRoom room = RoomAt(index);
+    uint32_t distance = distance_[index] + 1;
+    for (int d = 0; d < 4; ++d) {
+      Direction dir = static_cast<Direction>(d);
+      if (!IsPassageOpen(room, dir)) {
+        continue;
+      }
+      int neighbour = RoomIndex(Neighbour(room, dir));
+      if (distance < distance_[neighbour]) {
+        distance_[neighbour] = distance;
+        next_[neighbour] = Opposite(dir);
+        queue_.push_back(neighbour);
+      }
+    }
+  }
+  queue_.clear();
+}
+
+void FlowField::OnWallPartRemoved(int junction_x, int junction_z, int part) {
+  if (!has_target_) {
+    return;
+  }
+
+  // The two rooms on the sides of the wall part
+  LabyrinthRoom a, b;
+  int x = junction_x, z = junction_z;
+  switch (part) {
+    case 0: a = LabyrinthRoom{x-1, z}; b = LabyrinthRoom{x, z}; break;
+    case 1: a = LabyrinthRoom{x-1, z-1}; b = LabyrinthRoom{x-1, z}; break;
+    case 2: a = LabyrinthRoom{x-1, z-1}; b = LabyrinthRoom{x, z-1}; break;
+    default: a = LabyrinthRoom{x, z-1}; b = LabyrinthRoom{x, z}; break;
+  }
+  if (!IsValid(a) || !IsValid(b)) {
+    return;
+  }
+
+  // Only one of them can get closer through the new passage
+  int index_a = RoomIndex(a), index_b = RoomIndex(b);
+  if (distance_[index_a] < distance_[index_b]) {
+    std::swap(a, b);
+    std::swap(index_a, index_b);
+  }
+  if (distance_[index_b] == kUnreachable || distance_[index_b] + 1 >= distance_[index_a]) {
+    return;
+  }
+
+  Direction dir_to_b = a.x < b.x ? kPosX : a.x > b.x ? kNegX : a.z < b.z ? kPosZ : kNegZ;
+  distance_[index_a] = distance_[index_b] + 1;
+  next_[index_a] = dir_to_b;
+  queue_.push_back(index_a);
+  Relax();
+}
+
+int FlowField::GetDistance(const glm::dvec3& pos) const {
+  LabyrinthRoom room = GetRoom(pos);
+  if (!IsValid(room) || distance_[RoomIndex(room)] == kUnreachable) {
+    return -1;
+  }
+  return distance_[RoomIndex(room)];
+}
+
+bool FlowField::GetWaypoint(const glm::dvec3& pos, glm::dvec3* waypoint) const {
+  LabyrinthRoom room = GetRoom(pos);
+  if (!IsValid(room) || room == target_) {
+    return false;
+  }
+  Direction dir = static_cast<Direction>(next_[RoomIndex(room)]);
+  if (dir == kNone) {
+    return false;
+  }
+
+  // Steer towards the middle of the missing wall part, a bit into the next
+  // room, so the robot doesn't stop at the edge of the current one.
+  constexpr double kQuarter = kWallLength / 4, kOvershoot = 2.0;
+  int x = room.x, z = room.z;
+  double room_x = x * kWallLength, room_z = z * kWallLength;
+  switch (dir) {
+    case kNegX:
+    case kPosX: {
+      int junction_x = dir == kNegX ? x : x+1;
+      double gap_z = !HasWallPart(junction_x, z, 0) ? room_z + kQuarter
+                                                    : room_z + kWallLength - kQuarter;
+      double sign = dir == kNegX ? -1 : 1;
+      *waypoint = glm::dvec3{junction_x * kWallLength + sign*kOvershoot, pos.y, gap_z};
+    } break;
+    case kNegZ:
+    case kPosZ: {
+      int junction_z = dir == kNegZ ? z : z+1;
+      double gap_x = !HasWallPart(x, junction_z, 3) ? room_x + kQuarter
+                                                    : room_x + kWallLength - kQuarter;
+      double sign = dir == kNegZ ? -1 : 1;
+      *waypoint = glm::dvec3{gap_x, pos.y, junction_z * kWallLength + sign*kOvershoot};
+    } break;
+    default:
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_FLOW_FIELD_HPP_
+#define SIMULATION_FLOW_FIELD_HPP_
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "simulation/labyrinth_grid.hpp"
+
+// The rooms of the labyrinth are the squares between four junctions: room
+// (x, z) is between junction (x, z) and (x+1, z+1), including the ring of
+// rooms between the outermost junctions and the border walls.
+struct LabyrinthRoom {
+  int x, z;
+
+  bool operator==(const LabyrinthRoom& other) const { return x == other.x && z == other.z; }
+  bool operator!=(const LabyrinthRoom& other) const { return !(*this == other); }
+};
+
+// The shortest paths to a target room (the player's) from the rooms around
+// it, shared by all the robots. Only the paths within a window of
+// window_radius rooms around the target are searched, as only the robots
+// near the player are awake, and this keeps the field small and fast in
+// huge labyrinths. The distances are recomputed with a BFS when the target
+// changes, and relaxed incrementally when a wall part is destroyed, as that
+// can only make the paths shorter.
+class FlowField {
+ public:
+  static constexpr int kDefaultWindowRadius = 16;
+
+  // The field reads the walls from the grid, so it must outlive the field.
+  explicit FlowField(const LabyrinthGrid& grid, int window_radius = kDefaultWindowRadius);
+
+  static LabyrinthRoom GetRoom(const glm::dvec3& pos);
+
+  // Rebuilds the field if pos is in a different room than the last target.
+  void SetTarget(const glm::dvec3& pos);
+  LabyrinthRoom target() const { return target_; }
+
+  // Should be called after the part is removed from the grid.
+  void OnWallPartRemoved(int junction_x, int junction_z, int part);
+
+  // Returns the point that a robot at pos should steer towards to get to the
+  // next room on its path. Returns false if pos is in the target room, or if
+  // the target can't be reached from there.
+  bool GetWaypoint(const glm::dvec3& pos, glm::dvec3* waypoint) const;
+
+  // The number of passages between pos and the target, -1 if unreachable.
+  int GetDistance(const glm::dvec3& pos) const;
+
+ private:
+  enum Direction : uint8_t { kPosX, kNegX, kPosZ, kNegZ, kNone };
+
+  static constexpr uint32_t kUnreachable = UINT32_MAX;
+
+  const LabyrinthGrid& grid_;
+  int radius_;
+  int window_radius_;
+  int room_count_per_side_;
+  std::vector<uint32_t> distance_;
+  std::vector<uint8_t> next_;
+  LabyrinthRoom target_{0, 0};
+  bool has_target_ = false;
+  std::vector<int> queue_;
+
+  bool IsValid(LabyrinthRoom room) const;
+  int RoomIndex(LabyrinthRoom room) const;
+  LabyrinthRoom RoomAt(int index) const;
+  bool HasWallPart(int junction_x, int junction_z, int part) const {
+    return grid_.HasWallPart(junction_x, junction_z, part);
+  }
+  bool IsPassageOpen(LabyrinthRoom room, Direction dir) const;
+  static LabyrinthRoom Neighbour(LabyrinthRoom room, Direction dir);
+  static Direction Opposite(Direction dir);
+
+  void Rebuild();
+  // BFS from the rooms already in queue_
+  void Relax();
+};
+
+#endif
@@ -0,0 +1,31 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+
+#include "simulation/frame_time_summary.hpp"
+
+FrameTimeSummary FrameTimeSummary::Compute(const std::vector<double>& frame_times) {
+  FrameTimeSummary summary;
+  if (frame_times.empty()) {
+    return summary;
+  }
+
+  std::vector<double> sorted_times = frame_times;
+  std::sort(sorted_times.begin(), sorted_times.end());
+  summary.frame_count = sorted_times.size();
+  for (double frame_time : sorted_times) {
+    summary.total += frame_time;
+  }
+  summary.mean = summary.total / sorted_times.size();
+  summary.median = sorted_times[sorted_times.size() / 2];
+  summary.p99 = sorted_times[std::min(sorted_times.size() - 1, sorted_times.size() * 99 / 100)];
+  summary.max = sorted_times.back();
+  return summary;
+}
+
+void FrameTimeSummary::Print(std::ostream& os) const {
+  os << "Frame time mean:   " << mean * 1000.0 << " ms" << std::endl
+     << "Frame time median: " << median * 1000.0 << " ms" << std::endl
+     << "Frame time p99:    " << p99 * 1000.0 << " ms" << std::endl
+     << "Frame time max:    " << max * 1000.0 << " ms" << std::endl;
+}
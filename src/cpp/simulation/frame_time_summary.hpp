@@ -0,0 +1,24 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_FRAME_TIME_SUMMARY_HPP_
+#define SIMULATION_FRAME_TIME_SUMMARY_HPP_
+
+#include <ostream>
+#include <vector>
+
+// The distribution of the frame times of a run, in seconds.
+struct FrameTimeSummary {
+  int frame_count = 0;
+  double total = 0.0;
+  double mean = 0.0;
+  double median = 0.0;
+  double p99 = 0.0;
+  double max = 0.0;
+
+  static FrameTimeSummary Compute(const std::vector<double>& frame_times);
+
+  // One line per value, in milliseconds.
+  void Print(std::ostream& os) const;
+};
+
+#endif
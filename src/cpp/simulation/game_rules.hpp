@@ -0,0 +1,144 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_GAME_RULES_HPP_
+#define SIMULATION_GAME_RULES_HPP_
+
+#include <algorithm>
+#include <cstdlib>
+#include <Silice3D/common/math.hpp>
+#include "simulation/flow_field.hpp"
+#include "simulation/labyrinth.hpp"
+#include "simulation/random.hpp"
+#include "simulation/spatial_grid.hpp"
+
+// Gameplay rules shared by the scene graph objects and the headless simulation.
+namespace GameRules {
+
+// An explosion damages its surroundings once, when it detonates (see
+// simulation/explosion_damage.hpp), the rest of its life is only visual.
+constexpr double kExplosionRadius = 10.0;
+
+// The particles of an explosion effect. The detonations that are merged into
+// one blast share one effect, with a capped budget.
+constexpr int kExplosionParticleCount = 3000;
+constexpr int kMaxBlastParticleCount = 6000;
+
+inline int ExplosionParticleBudget(size_t detonation_count) {
+  return static_cast<int>(std::min<size_t>(kExplosionParticleCount * detonation_count,
+                                           kMaxBlastParticleCount));
+}
+
+// The particles alive at once (2800 of a single explosion's 3000).
+inline int ExplosionMaxParticlesAtOnce(int particle_budget) {
+  return particle_budget - particle_budget / 15;
+}
+
+// The particles are spawned in per frame bursts, bigger budgets in bigger
+// bursts, so every effect lasts as long.
+inline int ExplosionBurstSize(int particle_budget) {
+  return 8 * particle_budget / kExplosionParticleCount;
+}
+
+// The fire of a burning fuse
+constexpr int kFireMaxParticlesAtOnce = 1000;
+constexpr int kFireParticlesPerSecond = 200;
+
+// The fuse of a newly lit dynamite, from the gameplay random stream.
+inline double DynamiteTimeToExplode(Random& random) {
+  return 2.5 + 1.0*random.Rand01();
+}
+
+// The player puts down the dynamite in front of itself, on the ground.
+inline glm::dvec3 DroppedDynamitePos(const glm::dvec3& player_pos,
+                                     const glm::dvec3& player_forward) {
+  glm::dvec3 pos = player_pos + 3.0 * player_forward;
+  return glm::dvec3{pos.x, 0, pos.z};
+}
+
+// The F1 cheat lights this many dynamites around the center.
+constexpr int kScatteredDynamiteCount = 4;
+
+inline glm::dvec3 ScatteredDynamitePos(Random& random) {
+  double x = random.Rand01()*256-128;
+  return glm::dvec3{x, 0, random.Rand01()*256-128};
+}
+
+constexpr bool kRobotExplodes = false;
+constexpr double kRobotTimeToExplode = 2.0f;
+constexpr double kRobotSpeed = 9.0f;
+constexpr double kRobotDetectionRadius = 15.0f;
+
+// Everything that reacts to explosions is registered in the spatial grid at
+// most half a wall length away from the points it tests against the blast.
+inline double ExplosionQueryRadius(double exp_radius) {
+  return 1.2*exp_radius + kWallLength/2;
+}
+
+inline bool IsWallPartHit(const glm::dvec3& exp_position, double exp_radius,
+                          const glm::dvec3& part_center) {
+  return glm::length(exp_position - part_center) < exp_radius;
+}
+
+// Robots and the player are hit based on their ground position.
+inline bool IsActorHit(const glm::dvec3& exp_position, double exp_radius,
+                       glm::dvec3 actor_pos) {
+  actor_pos.y = 0;
+  return glm::length(actor_pos - exp_position) < 1.2*exp_radius;
+}
+
+inline bool IsBorderWallHit(const glm::dvec3& exp_position, double exp_radius,
+                            const glm::dvec3& wall_pos) {
+  return glm::length(exp_position - wall_pos) < 1.2*exp_radius;
+}
+
+// Robots are only updated in the cells around the player's cell, as points
+// in cells further away are at least a cell size away from each other.
+constexpr int kRobotActivationCellRadius = 1;
+static_assert(kRobotActivationCellRadius * kWallLength >= kRobotDetectionRadius,
+              "The robots around the player must be active");
+
+inline bool IsInRobotActivationRange(GridCell player_cell, GridCell robot_cell) {
+  return std::abs(player_cell.x - robot_cell.x) <= kRobotActivationCellRadius &&
+         std::abs(player_cell.z - robot_cell.z) <= kRobotActivationCellRadius;
+}
+
+template<typename T, typename Visitor>
+void ForEachInRobotActivationRange(const SpatialGrid<T>& grid, GridCell player_cell,
+                                   Visitor visitor) {
+  for (int x = -kRobotActivationCellRadius; x <= kRobotActivationCellRadius; ++x) {
+    for (int z = -kRobotActivationCellRadius; z <= kRobotActivationCellRadius; ++z) {
+      grid.ForEachInCell(GridCell(player_cell.x + x, player_cell.z + z), visitor);
+    }
+  }
+}
+
+// Returns false if the player is out of the robot's detection radius, or if
+// there's no path to it. The robots walk through the rooms on the path given
+// by the flow field, and go straight for the player in its room.
+inline bool RobotChaseVelocity(const glm::dvec3& robot_pos,
+                               const glm::dvec3& player_pos,
+                               const FlowField& flow_field,
+                               glm::dvec3* velocity) {
+  glm::dvec3 to_player = player_pos - robot_pos;
+  if (glm::length(to_player) > kRobotDetectionRadius) {
+    return false;
+  }
+
+  glm::dvec3 target = player_pos;
+  if (FlowField::GetRoom(robot_pos) != flow_field.target() &&
+      !flow_field.GetWaypoint(robot_pos, &target)) {
+    return false;
+  }
+
+  glm::dvec3 dir = target - robot_pos;
+  dir.y = 0;
+  if (glm::length(dir) > Silice3D::Math::kEpsilon) {
+    dir = glm::normalize(dir);
+  }
+  *velocity = kRobotSpeed * dir;
+  return true;
+}
+
+}
+
+#endif
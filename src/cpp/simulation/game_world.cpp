@@ -0,0 +1,353 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <utility>
+
+#include "simulation/game_world.hpp"
+#include "simulation/dynamite_fuse.hpp"
+#include "simulation/game_rules.hpp"
+#include "simulation/profiler.hpp"
+
+GameWorld::GameWorld(uint64_t seed, int labyrinth_radius, const glm::dvec3& player_pos,
+                     bool async_loading, GameWorldListener* listener)
+    : listener_(listener)
+    , random_(seed)
+    , async_loading_(async_loading)
+    , player_pos_(player_pos)
+    , grid_(new LabyrinthGrid{labyrinth_radius, random_})
+    , flow_field_(new FlowField{*grid_})
+    , dynamite_grid_(kWallLength) {
+  flow_field_->SetTarget(player_pos_);
+  robots_.SetPlayerPos(player_pos_);
+  if (async_loading_) {
+    loader_.reset(new LabyrinthChunkLoader{*grid_, collision_});
+  }
+
+  LabyrinthChunkCoord center = GetPlayerChunk();
+  for (int x = center.x - kChunkLoadRadius; x <= center.x + kChunkLoadRadius; ++x) {
+    for (int z = center.z - kChunkLoadRadius; z <= center.z + kChunkLoadRadius; ++z) {
+      LoadChunk(LabyrinthChunkLoader::Build(*grid_, collision_, LabyrinthChunkCoord{x, z}));
+    }
+  }
+}
+
+GameWorld::~GameWorld() {
+  // The loader thread reads the grid
+  loader_.reset();
+}
+
+LabyrinthChunkCoord GameWorld::GetPlayerChunk() const {
+  return LabyrinthChunkCoord::FromJunction(
+      static_cast<int>(std::floor(player_pos_.x / kWallLength)),
+      static_cast<int>(std::floor(player_pos_.z / kWallLength)));
+}
+
+void GameWorld::LoadChunk(LabyrinthChunkBuild&& build) {
+  PYROMAZE_PROFILE_ZONE("GameWorld::LoadChunk");
+  pending_chunks_.erase(build.chunk.Key());
+  if (chunks_.count(build.chunk.Key())) {
+    return;
+  }
+
+  // Explosions might have destroyed walls in the chunk during the build
+  grid_->LoadChunk(build.chunk, build.walls);
+  const LabyrinthChunkWalls& walls = *grid_->GetLoadedChunk(build.chunk);
+  if (walls != build.walls) {
+    build.walls = walls;
+    collision_.RebuildChunkShape(grid_->radius(), build.chunk, walls,
+                                 build.collision_shape.get());
+  }
+
+  chunks_[build.chunk.Key()] = LoadedChunk{build.chunk, build.collision_shape.get()};
+  listener_->OnChunkLoaded(build.chunk, build.walls, std::move(build.collision_shape));
+  for (GridCell junction : build.robots) {
+    AddRobot(junction);
+  }
+}
+
+void GameWorld::UnloadChunk(LabyrinthChunkCoord chunk) {
+  // The robots belong to the chunk they spawned in, wherever they are
+  std::vector<RobotState*> removed;
+  robots_.ForEach([&](RobotState* robot) {
+    if (LabyrinthChunkCoord::FromJunction(robot->spawn_junction.x,
+                                          robot->spawn_junction.z) == chunk) {
+      removed.push_back(robot);
+    }
+  });
+  for (RobotState* robot : removed) {
+    RemoveRobot(robot);
+  }
+
+  grid_->UnloadChunk(chunk);
+  listener_->OnChunkUnloaded(chunk);
+  chunks_.erase(chunk.Key());
+}
+
+void GameWorld::UpdateChunks() {
+  PYROMAZE_PROFILE_ZONE("GameWorld::UpdateChunks");
+  if (loader_) {
+    for (LabyrinthChunkBuild& build : loader_->TakeFinished()) {
+      LoadChunk(std::move(build));
+    }
+  }
+
+  LabyrinthChunkCoord center = GetPlayerChunk();
+
+  std::vector<LabyrinthChunkCoord> far_chunks;
+  for (const auto& pair : chunks_) {
+    if (ChunkDistance(center, pair.second.coord) > kChunkUnloadRadius) {
+      far_chunks.push_back(pair.second.coord);
+    }
+  }
+  for (LabyrinthChunkCoord chunk : far_chunks) {
+    UnloadChunk(chunk);
+  }
+
+  for (int x = center.x - kChunkLoadRadius; x <= center.x + kChunkLoadRadius; ++x) {
+    for (int z = center.z - kChunkLoadRadius; z <= center.z + kChunkLoadRadius; ++z) {
+      LabyrinthChunkCoord chunk{x, z};
+      if (chunks_.count(chunk.Key()) || pending_chunks_.count(chunk.Key())) {
+        continue;
+      }
+      if (loader_) {
+        pending_chunks_.insert(chunk.Key());
+        loader_->Request(chunk);
+      } else {
+        LoadChunk(LabyrinthChunkLoader::Build(*grid_, collision_, chunk));
+      }
+    }
+  }
+}
+
+void GameWorld::AddRobot(GridCell spawn_junction) {
+  glm::dvec3 pos{spawn_junction.x * kWallLength + kWallLength/2.0, 3,
+                 spawn_junction.z * kWallLength + kWallLength/2.0};
+  std::unique_ptr<RobotState> robot{new RobotState{}};
+  robot->spawn_junction = spawn_junction;
+  robot->body = listener_->OnRobotAdded(robot.get(), pos);
+  robots_.Add(std::move(robot));
+}
+
+void GameWorld::RemoveRobot(RobotState* robot) {
+  std::unique_ptr<RobotState> removed = robots_.Remove(robot);
+  listener_->OnRobotRemoved(robot);
+}
+
+void GameWorld::AddDynamite(const glm::dvec3& pos) {
+  std::unique_ptr<DynamiteState> dynamite{new DynamiteState{}};
+  dynamite->pos = pos;
+  dynamite->spawn_time = current_time_;
+  dynamite->time_to_explode = GameRules::DynamiteTimeToExplode(random_.Get(RandomStream::kGameplay));
+  dynamite->fire_pos = FusePosition(0);
+  dynamite->cell_ = dynamite_grid_.GetCell(pos);
+  dynamite->index_ = dynamites_.size();
+  dynamite_grid_.Insert(dynamite.get(), dynamite->cell_);
+  dynamites_.push_back(std::move(dynamite));
+  listener_->OnDynamiteAdded(dynamites_.back().get());
+}
+
+void GameWorld::DropDynamite(const glm::dvec3& player_pos, const glm::dvec3& player_forward) {
+  PYROMAZE_PROFILE_ZONE("Dynamite creation");
+  AddDynamite(GameRules::DroppedDynamitePos(player_pos, player_forward));
+}
+
+void GameWorld::ScatterDynamites() {
+  PYROMAZE_PROFILE_ZONE("Dynamite creation");
+  for (int i = 0; i < GameRules::kScatteredDynamiteCount; ++i) {
+    AddDynamite(GameRules::ScatteredDynamitePos(random_.Get(RandomStream::kGameplay)));
+  }
+}
+
+void GameWorld::RemoveDynamite(DynamiteState* dynamite) {
+  dynamite_grid_.Remove(dynamite, dynamite->cell_);
+  size_t index = dynamite->index_;
+  std::swap(dynamites_[index], dynamites_.back());
+  dynamites_[index]->index_ = index;
+  std::unique_ptr<DynamiteState> removed = std::move(dynamites_.back());
+  dynamites_.pop_back();
+  listener_->OnDynamiteRemoved(dynamite);
+}
+
+void GameWorld::UpdateDynamites() {
+  PYROMAZE_PROFILE_ZONE("GameWorld::UpdateDynamites");
+  for (size_t i = 0; i < dynamites_.size();) {
+    DynamiteState* dynamite = dynamites_[i].get();
+    double current_phase = (current_time_ - dynamite->spawn_time) / dynamite->time_to_explode;
+    if (current_phase > 1) {
+      detonations_.Push(dynamite->pos);
+      // Swaps the last dynamite to i
+      RemoveDynamite(dynamite);
+      continue;
+    }
+
+    dynamite->fire_pos = FusePosition(current_phase);
+    ++i;
+  }
+}
+
+void GameWorld::Reset(uint64_t seed, const glm::dvec3& player_pos) {
+  PYROMAZE_PROFILE_ZONE("GameWorld::Reset");
+  detonations_.Clear();
+  while (!dynamites_.empty()) {
+    RemoveDynamite(dynamites_.back().get());
+  }
+  std::vector<RobotState*> robots;
+  robots_.ForEach([&](RobotState* robot) { robots.push_back(robot); });
+  for (RobotState* robot : robots) {
+    RemoveRobot(robot);
+  }
+
+  player_pos_ = player_pos;
+  robots_.SetPlayerPos(player_pos_);
+  random_ = RandomStreams{seed};
+
+  // Drops the builds of the old labyrinth
+  loader_.reset();
+  pending_chunks_.clear();
+  // The old flow field refers to the old grid
+  std::unique_ptr<LabyrinthGrid> grid{new LabyrinthGrid{grid_->radius(), random_}};
+  std::unique_ptr<FlowField> flow_field{new FlowField{*grid}};
+  flow_field->SetTarget(player_pos_);
+  flow_field_ = std::move(flow_field);
+  grid_ = std::move(grid);
+  if (async_loading_) {
+    loader_.reset(new LabyrinthChunkLoader{*grid_, collision_});
+  }
+
+  LabyrinthChunkCoord center = GetPlayerChunk();
+  std::vector<LabyrinthChunkCoord> far_chunks;
+  for (const auto& pair : chunks_) {
+    if (ChunkDistance(center, pair.second.coord) > kChunkLoadRadius) {
+      far_chunks.push_back(pair.second.coord);
+    }
+  }
+  for (LabyrinthChunkCoord chunk : far_chunks) {
+    listener_->OnChunkUnloaded(chunk);
+    chunks_.erase(chunk.Key());
+  }
+
+  for (int x = center.x - kChunkLoadRadius; x <= center.x + kChunkLoadRadius; ++x) {
+    for (int z = center.z - kChunkLoadRadius; z <= center.z + kChunkLoadRadius; ++z) {
+      LabyrinthChunkCoord coord{x, z};
+      LabyrinthChunkBuild build = LabyrinthChunkLoader::Build(*grid_, collision_, coord);
+      auto iter = chunks_.find(coord.Key());
+      if (iter == chunks_.end()) {
+        LoadChunk(std::move(build));
+        continue;
+      }
+
+      // The kept chunk's own shape is rebuilt, the build's isn't needed
+      grid_->LoadChunk(coord, build.walls);
+      collision_.RebuildChunkShape(grid_->radius(), coord, build.walls,
+                                   iter->second.collision_shape);
+      listener_->OnChunkWallsReset(coord, build.walls);
+      for (GridCell junction : build.robots) {
+        AddRobot(junction);
+      }
+    }
+  }
+}
+
+void GameWorld::Update(double current_time, const glm::dvec3& player_pos) {
+  PYROMAZE_PROFILE_ZONE("GameWorld::Update");
+  current_time_ = current_time;
+  player_pos_ = player_pos;
+
+  ResolveDetonations();
+  UpdateChunks();
+
+  flow_field_->SetTarget(player_pos_);
+  robots_.SetPlayerPos(player_pos_);
+  std::vector<RobotState*> exploded;
+  robots_.Update(player_pos_, *flow_field_, current_time_, &detonations_, &exploded);
+  for (RobotState* robot : exploded) {
+    grid_->RecordRobotKilled(robot->spawn_junction.x, robot->spawn_junction.z);
+    RemoveRobot(robot);
+  }
+
+  UpdateDynamites();
+}
+
+void GameWorld::ResolveDetonations() {
+  if (detonations_.empty()) {
+    return;
+  }
+  PYROMAZE_PROFILE_ZONE("GameWorld::ResolveDetonations");
+
+  // The dynamites that the blasts set off are pushed to the emptied queue.
+  // The blasts of a frame that don't overlap might hit the player or the
+  // border walls more than once, that's reported once.
+  bool player_hit = false, border_wall_hit = false;
+  for (const Blast& blast : detonations_.TakeBlasts()) {
+    ReactToExplosion(blast);
+    listener_->OnBlast(blast);
+    player_hit = player_hit || blast.HitsActor(player_pos_);
+    border_wall_hit = border_wall_hit || HitsBorderWall(blast);
+  }
+
+  if (player_hit) {
+    listener_->OnPlayerHit();
+  }
+  if (border_wall_hit) {
+    listener_->OnBorderWallHit();
+  }
+}
+
+void GameWorld::ReactToExplosion(const Blast& blast) {
+  PYROMAZE_PROFILE_ZONE("GameWorld::ReactToExplosion");
+  std::vector<WallPartHit> hits;
+  FindWallPartsHit(*grid_, collision_, blast, &hits);
+  for (LabyrinthChunkCoord chunk : DestroyWallParts(hits, grid_.get(), flow_field_.get())) {
+    auto iter = chunks_.find(chunk.Key());
+    if (iter != chunks_.end()) {
+      collision_.RebuildChunkShape(grid_->radius(), chunk, *grid_->GetLoadedChunk(chunk),
+                                   iter->second.collision_shape);
+      listener_->OnWallPartsRemoved(chunk, hits);
+    }
+  }
+
+  std::vector<RobotState*> hit_robots;
+  robots_.FindRobotsHit(blast, &hit_robots);
+  for (RobotState* robot : hit_robots) {
+    if (GameRules::kRobotExplodes) {
+      // Sets off its neighbours in the next tick
+      detonations_.Push(robot->GetPos());
+    }
+    grid_->RecordRobotKilled(robot->spawn_junction.x, robot->spawn_junction.z);
+    RemoveRobot(robot);
+  }
+
+  // Chain reaction, in the next tick
+  std::vector<DynamiteState*> hit_dynamites;
+  dynamite_grid_.Query(blast.center, blast.QueryRadius(), [&](DynamiteState* dynamite) {
+    if (blast.HitsActor(dynamite->pos)) {
+      hit_dynamites.push_back(dynamite);
+    }
+  });
+  for (DynamiteState* dynamite : hit_dynamites) {
+    detonations_.Push(dynamite->pos);
+    chain_detonation_count_++;
+    RemoveDynamite(dynamite);
+  }
+}
+
+bool GameWorld::HitsBorderWall(const Blast& blast) const {
+  // The border walls stand on the junctions of the ring around the labyrinth
+  int border = grid_->radius() + 1;
+  double radius = blast.QueryRadius();
+  int min_x = std::max(-border, static_cast<int>(std::ceil((blast.center.x - radius) / kWallLength)));
+  int max_x = std::min(border, static_cast<int>(std::floor((blast.center.x + radius) / kWallLength)));
+  int min_z = std::max(-border, static_cast<int>(std::ceil((blast.center.z - radius) / kWallLength)));
+  int max_z = std::min(border, static_cast<int>(std::floor((blast.center.z + radius) / kWallLength)));
+  for (int x = min_x; x <= max_x; ++x) {
+    for (int z = min_z; z <= max_z; ++z) {
+      if ((std::abs(x) == border || std::abs(z) == border) &&
+          blast.HitsBorderWall(glm::dvec3(LabyrinthGrid::GetJunctionPos(x, z)))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
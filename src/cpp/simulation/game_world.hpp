@@ -0,0 +1,152 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_GAME_WORLD_HPP_
+#define SIMULATION_GAME_WORLD_HPP_
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <btBulletDynamicsCommon.h>
+
+#include "simulation/detonation_queue.hpp"
+#include "simulation/explosion_damage.hpp"
+#include "simulation/flow_field.hpp"
+#include "simulation/labyrinth_chunk_loader.hpp"
+#include "simulation/labyrinth_collision.hpp"
+#include "simulation/labyrinth_grid.hpp"
+#include "simulation/random.hpp"
+#include "simulation/robot_swarm.hpp"
+#include "simulation/spatial_grid.hpp"
+
+// A lit dynamite.
+struct DynamiteState {
+  glm::dvec3 pos;
+  double spawn_time, time_to_explode;
+  // The burning end of the fuse, in the dynamite's model space
+  glm::vec3 fire_pos;
+
+ private:
+  GridCell cell_;
+  size_t index_ = 0;
+  friend class GameWorld;
+};
+
+// Told about everything that appears in or disappears from the world, to
+// show it: MainScene creates the scene objects, the headless simulation only
+// creates the collision objects and the particle simulations.
+class GameWorldListener {
+ public:
+  virtual ~GameWorldListener() {}
+
+  // The world rebuilds the collision shape when the walls change, it has to
+  // be kept alive until the chunk is unloaded.
+  virtual void OnChunkLoaded(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls,
+                             std::unique_ptr<btCompoundShape> collision_shape) = 0;
+  // A reset kept the chunk loaded, with the walls of the new labyrinth.
+  virtual void OnChunkWallsReset(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls) = 0;
+  // The parts are already removed from the grid and the collision shape,
+  // the ones in other chunks should be ignored.
+  virtual void OnWallPartsRemoved(LabyrinthChunkCoord chunk,
+                                  const std::vector<WallPartHit>& parts) = 0;
+  virtual void OnChunkUnloaded(LabyrinthChunkCoord chunk) = 0;
+
+  // Returns the robot's body, created at pos. It must stay alive until the
+  // robot is removed.
+  virtual btRigidBody* OnRobotAdded(RobotState* robot, const glm::dvec3& pos) = 0;
+  virtual void OnRobotRemoved(RobotState* robot) = 0;
+
+  virtual void OnDynamiteAdded(DynamiteState* dynamite) = 0;
+  virtual void OnDynamiteRemoved(DynamiteState* dynamite) = 0;
+
+  // After the damage of the blast was applied, for its effects.
+  virtual void OnBlast(const Blast& blast) = 0;
+  // At most once per frame each, after the frame's blasts.
+  virtual void OnPlayerHit() = 0;
+  // Blowing up a border wall is how the player escapes.
+  virtual void OnBorderWallHit() = 0;
+};
+
+// The game logic of a labyrinth: the chunks streamed around the player, the
+// robots, the dynamites and the blasts, with the random streams of the seed.
+// Both MainScene and the headless simulation run the game through this, they
+// only differ in how they show it (and who owns the physics world).
+class GameWorld {
+ public:
+  // Loads the chunks around the player synchronously. With async_loading,
+  // the chunks that are loaded later are built on a loader thread, otherwise
+  // the loading is synchronous and deterministic.
+  GameWorld(uint64_t seed, int labyrinth_radius, const glm::dvec3& player_pos,
+            bool async_loading, GameWorldListener* listener);
+  // Doesn't notify the listener, the shapes and bodies given to it can be
+  // destroyed after the world.
+  ~GameWorld();
+
+  uint64_t seed() const { return random_.seed(); }
+  Random& GetRandom(RandomStream stream) { return random_.Get(stream); }
+  double current_time() const { return current_time_; }
+
+  const LabyrinthGrid& grid() const { return *grid_; }
+  const FlowField& flow_field() const { return *flow_field_; }
+  const RobotSwarm& robots() const { return robots_; }
+  size_t dynamite_count() const { return dynamites_.size(); }
+  size_t loaded_chunk_count() const { return chunks_.size(); }
+  size_t chain_detonation_count() const { return chain_detonation_count_; }
+  // Resolved at the start of the next Update
+  DetonationQueue* detonations() { return &detonations_; }
+
+  // Lights a dynamite, with a random fuse from the gameplay stream.
+  void AddDynamite(const glm::dvec3& pos);
+  // What the player's keys do: space puts down a dynamite in front of the
+  // player, F1 lights kScatteredDynamiteCount around the center.
+  void DropDynamite(const glm::dvec3& player_pos, const glm::dvec3& player_forward);
+  void ScatterDynamites();
+
+  // Switches to the labyrinth of the seed, with the player at player_pos.
+  // The dynamites and the robots are removed, the chunks that stay loaded
+  // are reused, only their walls are reset.
+  void Reset(uint64_t seed, const glm::dvec3& player_pos);
+
+  // A tick of the game: resolves the detonations of the last tick, streams
+  // the chunks around the player, and updates the robots and the fuses.
+  void Update(double current_time, const glm::dvec3& player_pos);
+
+ private:
+  struct LoadedChunk {
+    LabyrinthChunkCoord coord;
+    btCompoundShape* collision_shape;
+  };
+
+  GameWorldListener* listener_;
+  RandomStreams random_;
+  bool async_loading_;
+  double current_time_ = 0.0;
+  glm::dvec3 player_pos_;
+  size_t chain_detonation_count_ = 0;
+
+  std::unique_ptr<LabyrinthGrid> grid_;
+  std::unique_ptr<FlowField> flow_field_;
+  LabyrinthCollision collision_;
+  std::unique_ptr<LabyrinthChunkLoader> loader_;
+  std::unordered_map<uint64_t, LoadedChunk> chunks_;
+  std::unordered_set<uint64_t> pending_chunks_;
+
+  RobotSwarm robots_;
+  std::vector<std::unique_ptr<DynamiteState>> dynamites_;
+  SpatialGrid<DynamiteState> dynamite_grid_;
+  DetonationQueue detonations_;
+
+  LabyrinthChunkCoord GetPlayerChunk() const;
+  void LoadChunk(LabyrinthChunkBuild&& build);
+  void UnloadChunk(LabyrinthChunkCoord chunk);
+  void UpdateChunks();
+  void AddRobot(GridCell spawn_junction);
+  void RemoveRobot(RobotState* robot);
+  void RemoveDynamite(DynamiteState* dynamite);
+  void UpdateDynamites();
+  void ResolveDetonations();
+  void ReactToExplosion(const Blast& blast);
+  bool HitsBorderWall(const Blast& blast) const;
+};
+
+#endif
@@ -0,0 +1,289 @@
+// Copyright (c) Tamas Csala
+
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <algorithm>
+
+#include "simulation/headless_simulation.hpp"
+#include "simulation/frame_time_summary.hpp"
+#include "simulation/game_rules.hpp"
+#include "simulation/process_stats.hpp"
+#include "simulation/profiler.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+btVector3 ToBt(const glm::dvec3& v) {
+  return btVector3(v.x, v.y, v.z);
+}
+
+}
+
+HeadlessSimulation::HeadlessSimulation(const HeadlessOptions& options)
+    : options_(options)
+    , job_system_(options.thread_count != 0 ? options.thread_count
+                                            : std::thread::hardware_concurrency()) {
+  Clock::time_point start = Clock::now();
+  if (options_.replay) {
+    options_.frame_count = options_.replay->ticks.size();
+  }
+
+  collision_config_.reset(new btDefaultCollisionConfiguration());
+  dispatcher_.reset(new btCollisionDispatcher(collision_config_.get()));
+  broadphase_.reset(new btDbvtBroadphase());
+  solver_.reset(new btSequentialImpulseConstraintSolver());
+  world_.reset(new btDiscreteDynamicsWorld(dispatcher_.get(), broadphase_.get(),
+                                           solver_.get(), collision_config_.get()));
+  world_->setGravity(btVector3(0, 0, 0));
+  robot_shape_.reset(new btSphereShape(1.0));
+
+  double loaded_radius = (kChunkLoadRadius + 0.5) * kLabyrinthChunkSize * kWallLength;
+  dynamite_radius_ = std::min(loaded_radius, double(options_.labyrinth_radius * kWallLength));
+
+  // The chunks are loaded synchronously, so the runs are reproducible
+  game_.reset(new GameWorld{options_.seed, options_.labyrinth_radius, player_pos_, false, this});
+
+  load_time_ = SecondsSince(start);
+}
+
+HeadlessSimulation::~HeadlessSimulation() {
+  for (auto& pair : robots_) {
+    world_->removeRigidBody(pair.second.get());
+  }
+  for (auto& pair : chunks_) {
+    world_->removeCollisionObject(pair.second.body.get());
+  }
+}
+
+void HeadlessSimulation::OnChunkLoaded(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls&,
+                                       std::unique_ptr<btCompoundShape> collision_shape) {
+  Chunk& loaded = chunks_[chunk.Key()];
+  loaded.shape = std::move(collision_shape);
+  loaded.body.reset(new btCollisionObject());
+  loaded.body->setCollisionShape(loaded.shape.get());
+  world_->addCollisionObject(loaded.body.get(), btBroadphaseProxy::StaticFilter,
+      btBroadphaseProxy::AllFilter ^ btBroadphaseProxy::StaticFilter);
+}
+
+void HeadlessSimulation::OnChunkUnloaded(LabyrinthChunkCoord chunk) {
+  auto iter = chunks_.find(chunk.Key());
+  world_->removeCollisionObject(iter->second.body.get());
+  chunks_.erase(iter);
+}
+
+// The same body as the Robot scene object's
+btRigidBody* HeadlessSimulation::OnRobotAdded(RobotState* robot, const glm::dvec3& pos) {
+  btVector3 inertia;
+  robot_shape_->calculateLocalInertia(1.0f, inertia);
+  btRigidBody::btRigidBodyConstructionInfo info{1.0f, nullptr, robot_shape_.get(), inertia};
+  info.m_startWorldTransform.setIdentity();
+  info.m_startWorldTransform.setOrigin(ToBt(pos));
+
+  std::unique_ptr<btRigidBody> body{new btRigidBody(info)};
+  body->setLinearFactor(btVector3(1, 0, 1));
+  body->setAngularFactor(btVector3(0, 0, 0));
+  world_->addRigidBody(body.get());
+  btRigidBody* added = body.get();
+  robots_[robot] = std::move(body);
+  return added;
+}
+
+void HeadlessSimulation::OnRobotRemoved(RobotState* robot) {
+  auto iter = robots_.find(robot);
+  world_->removeRigidBody(iter->second.get());
+  robots_.erase(iter);
+}
+
+void HeadlessSimulation::OnDynamiteAdded(DynamiteState* dynamite) {
+  Random particle_random = game_->GetRandom(RandomStream::kParticles).Fork();
+  fires_[dynamite].reset(new Fire{dynamite, ParticleSimulation{
+      FireParticle, particle_random, GameRules::kFireMaxParticlesAtOnce,
+      GameRules::kFireParticlesPerSecond}});
+}
+
+void HeadlessSimulation::OnDynamiteRemoved(DynamiteState* dynamite) {
+  fires_.erase(dynamite);
+}
+
+void HeadlessSimulation::OnBlast(const Blast& blast) {
+  int particle_budget = blast.ParticleBudget();
+  Random particle_random = game_->GetRandom(RandomStream::kParticles).Fork();
+  explosions_.push_back(Explosion{blast.center,
+                                  ParticleSimulation{ExplosionParticle, particle_random,
+                                                     GameRules::ExplosionMaxParticlesAtOnce(particle_budget),
+                                                     0, particle_budget},
+                                  GameRules::ExplosionBurstSize(particle_budget)});
+}
+
+void HeadlessSimulation::SpawnDynamites() {
+  PYROMAZE_PROFILE_ZONE("HeadlessSimulation::SpawnDynamites");
+  while (next_dynamite_time_ <= current_time_) {
+    Random& random = game_->GetRandom(RandomStream::kGameplay);
+    game_->AddDynamite(glm::dvec3{player_pos_.x + (2*random.Rand01() - 1) * dynamite_radius_, 0,
+                                  player_pos_.z + (2*random.Rand01() - 1) * dynamite_radius_});
+    next_dynamite_time_ += options_.dynamite_interval;
+  }
+}
+
+// What Player::KeyAction does with the recorded key presses. The other keys
+// (resets, freezing the scene) aren't simulated.
+void HeadlessSimulation::ReplayInput() {
+  PYROMAZE_PROFILE_ZONE("HeadlessSimulation::ReplayInput");
+  const InputTick& tick = options_.replay->ticks[replay_tick_++];
+  player_pos_ = tick.camera_pos;
+  player_forward_ = tick.camera_forward;
+  for (const InputEvent& event : tick.events) {
+    if (event.action != kInputPress) {
+      continue;
+    }
+    if (event.key == kInputKeySpace) {
+      game_->DropDynamite(player_pos_, player_forward_);
+    } else if (event.key == kInputKeyF1) {
+      game_->ScatterDynamites();
+    }
+  }
+}
+
+void HeadlessSimulation::UpdateExplosions() {
+  PYROMAZE_PROFILE_ZONE("HeadlessSimulation::UpdateExplosions");
+  for (size_t i = 0; i < explosions_.size();) {
+    Explosion& explosion = explosions_[i];
+    // Finished during the last frame's particle update
+    if (explosion.particles.IsFinished()) {
+      explosions_[i] = std::move(explosions_.back());
+      explosions_.pop_back();
+      continue;
+    }
+    ++i;
+  }
+}
+
+void HeadlessSimulation::UpdateParticles() {
+  PYROMAZE_PROFILE_ZONE("HeadlessSimulation::UpdateParticles");
+  Clock::time_point start = Clock::now();
+
+  // The particle systems are independent from each other and from the rest
+  // of the simulation. A single system is too little work for a job, so
+  // every thread gets a slice of them.
+  float dt = options_.timestep;
+  float current_time = current_time_;
+  updated_fires_.clear();
+  for (auto& pair : fires_) {
+    updated_fires_.push_back(pair.second.get());
+  }
+  size_t fire_count = updated_fires_.size();
+  job_system_.ParallelFor(fire_count + explosions_.size(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      if (i < fire_count) {
+        Fire* fire = updated_fires_[i];
+        glm::vec3 pos = glm::vec3(fire->dynamite->pos) + fire->dynamite->fire_pos;
+        fire->particles.Update(pos, current_time, dt);
+      } else {
+        Explosion& explosion = explosions_[i - fire_count];
+        glm::vec3 pos{explosion.pos};
+        explosion.particles.SpawnBurst(pos, current_time, explosion.burst_size);
+        explosion.particles.Update(pos, current_time, dt);
+      }
+    }
+  });
+
+  particle_time_ += SecondsSince(start);
+}
+
+void HeadlessSimulation::Step() {
+  PYROMAZE_PROFILE_FRAME();
+  PYROMAZE_PROFILE_ZONE("HeadlessSimulation::Step");
+  current_time_ += options_.timestep;
+
+  // The input is handled before the world's update, as in MainScene
+  if (options_.replay) {
+    ReplayInput();
+  } else {
+    SpawnDynamites();
+  }
+  game_->Update(current_time_, player_pos_);
+  UpdateExplosions();
+  UpdateParticles();
+
+  PYROMAZE_PROFILE_ZONE("Physics");
+  Clock::time_point physics_start = Clock::now();
+  world_->stepSimulation(options_.timestep, 1, options_.timestep);
+  physics_time_ += SecondsSince(physics_start);
+}
+
+HeadlessStats HeadlessSimulation::Run() {
+  std::vector<double> frame_times;
+  frame_times.reserve(options_.frame_count);
+
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < options_.frame_count; ++i) {
+    Clock::time_point frame_start = Clock::now();
+    Step();
+    frame_times.push_back(SecondsSince(frame_start));
+  }
+  double total_time = SecondsSince(start);
+  FrameTimeSummary frame_time_summary = FrameTimeSummary::Compute(frame_times);
+
+  HeadlessStats stats;
+  stats.labyrinth_radius = options_.labyrinth_radius;
+  stats.load_time = load_time_;
+  stats.peak_rss = PeakResidentSetSize();
+  stats.grid_memory = game_->grid().memory_usage();
+  stats.loaded_chunks = game_->loaded_chunk_count();
+  stats.physics_proxies = world_->getNumCollisionObjects();
+  stats.robots = game_->robots().size();
+  stats.awake_robots = game_->robots().awake_count();
+  stats.destroyed_wall_parts = game_->grid().destroyed_wall_part_count();
+  stats.frame_count = options_.frame_count;
+  stats.frame_time_mean = frame_time_summary.mean;
+  stats.frame_time_p99 = frame_time_summary.p99;
+  stats.frame_time_max = frame_time_summary.max;
+
+  std::cout << "Seed:              " << game_->seed() << std::endl
+            << "Labyrinth radius:  " << stats.labyrinth_radius << std::endl
+            << "Load time:         " << stats.load_time * 1000.0 << " ms" << std::endl
+            << "Peak RSS:          " << stats.peak_rss / (1024.0 * 1024.0) << " MiB" << std::endl
+            << "Labyrinth grid:    " << stats.grid_memory << " bytes" << std::endl
+            << "Loaded chunks:     " << stats.loaded_chunks << std::endl
+            << "Physics proxies:   " << stats.physics_proxies << std::endl
+            << "Frames:            " << options_.frame_count
+            << " (dt = " << options_.timestep << " s)" << std::endl
+            << "Total time:        " << total_time * 1000.0 << " ms" << std::endl;
+  frame_time_summary.Print(std::cout);
+  std::cout << "Particle threads:  " << job_system_.thread_count() << std::endl
+            << "Particle time:     " << particle_time_ * 1000.0 << " ms" << std::endl
+            << "Physics time:      " << physics_time_ * 1000.0 << " ms"
+            << " (" << physics_time_ * 1000.0 / std::max(options_.frame_count, 1)
+            << " ms per step)" << std::endl
+            << "Wall parts broken: " << stats.destroyed_wall_parts << std::endl
+            << "Robots left:       " << stats.robots
+            << " (" << stats.awake_robots << " awake)" << std::endl
+            << "Live dynamites:    " << game_->dynamite_count() << std::endl
+            << "Live explosions:   " << explosions_.size() << std::endl
+            << "Chain detonations: " << game_->chain_detonation_count() << std::endl
+            << "Player hit:        " << player_hit_count_ << " times" << std::endl
+            << "Border wall hit:   " << border_wall_hit_count_ << " times" << std::endl;
+
+  return stats;
+}
+
+void HeadlessStats::WriteCsvHeader(std::ostream& os) {
+  os << "complexity,labyrinth_radius,load_time_ms,peak_rss_bytes,grid_memory_bytes,"
+     << "loaded_chunks,physics_proxies,robots,awake_robots,destroyed_wall_parts,"
+     << "frames,frame_time_mean_ms,frame_time_p99_ms,frame_time_max_ms" << std::endl;
+}
+
+void HeadlessStats::WriteCsvRow(std::ostream& os, const char* name) const {
+  os << name << ',' << labyrinth_radius << ',' << load_time * 1000.0 << ','
+     << peak_rss << ',' << grid_memory << ',' << loaded_chunks << ','
+     << physics_proxies << ',' << robots << ',' << awake_robots << ','
+     << destroyed_wall_parts << ',' << frame_count << ','
+     << frame_time_mean * 1000.0 << ',' << frame_time_p99 * 1000.0 << ','
+     << frame_time_max * 1000.0 << std::endl;
+}
@@ -0,0 +1,136 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_HEADLESS_SIMULATION_HPP_
+#define SIMULATION_HEADLESS_SIMULATION_HPP_
+
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include <btBulletDynamicsCommon.h>
+
+#include "simulation/game_world.hpp"
+#include "simulation/input_recording.hpp"
+#include "simulation/job_system.hpp"
+#include "simulation/particle_simulation.hpp"
+#include "settings.hpp"
+
+struct HeadlessOptions {
+  uint64_t seed = 0;
+  int labyrinth_radius = Settings::kLabyrinthRadius;
+  int frame_count = 600;
+  double timestep = 1.0 / 60.0;
+  // A dynamite is dropped at a random position of the loaded part of the
+  // labyrinth this often.
+  double dynamite_interval = 0.5;
+  // Threads updating the particle systems, 0 means hardware_concurrency.
+  unsigned thread_count = 0;
+  // If set, the player moves and drops the dynamites as in the recording,
+  // instead of the random drops. Its seed, radius and timestep must be used.
+  const InputRecording* replay = nullptr;
+};
+
+// The measurements of a run, one row of the complexity sweep's CSV.
+struct HeadlessStats {
+  int labyrinth_radius = 0;
+  double load_time = 0.0;
+  size_t peak_rss = 0;
+  size_t grid_memory = 0;
+  size_t loaded_chunks = 0;
+  size_t physics_proxies = 0;
+  size_t robots = 0;
+  size_t awake_robots = 0;
+  size_t destroyed_wall_parts = 0;
+  int frame_count = 0;
+  double frame_time_mean = 0.0;
+  double frame_time_p99 = 0.0;
+  double frame_time_max = 0.0;
+
+  static void WriteCsvHeader(std::ostream& os);
+  void WriteCsvRow(std::ostream& os, const char* name) const;
+};
+
+// Runs the game logic of MainScene (the GameWorld, with the same particle
+// systems and a bullet physics step) with a fixed timestep, without creating
+// a window or touching OpenGL. It only shows the world differently: the
+// chunks and the robots get collision objects, the fires and explosions get
+// particle simulations.
+class HeadlessSimulation : private GameWorldListener {
+ public:
+  explicit HeadlessSimulation(const HeadlessOptions& options);
+  ~HeadlessSimulation();
+
+  void Step();
+
+  // Runs options.frame_count steps, and prints the timings to stdout.
+  HeadlessStats Run();
+
+ private:
+  struct Chunk {
+    std::unique_ptr<btCompoundShape> shape;
+    std::unique_ptr<btCollisionObject> body;
+  };
+
+  struct Fire {
+    const DynamiteState* dynamite;
+    ParticleSimulation particles;
+  };
+
+  struct Explosion {
+    glm::dvec3 pos;
+    ParticleSimulation particles;
+    int burst_size;
+  };
+
+  HeadlessOptions options_;
+  JobSystem job_system_;
+  double current_time_ = 0.0;
+  double next_dynamite_time_ = 0.0;
+  double dynamite_radius_ = 0.0;
+  glm::dvec3 player_pos_{16, 3, 8};
+  glm::dvec3 player_forward_{-1, 0, 0};
+  size_t replay_tick_ = 0;
+  int player_hit_count_ = 0;
+  int border_wall_hit_count_ = 0;
+  double load_time_ = 0.0;
+  double particle_time_ = 0.0;
+  double physics_time_ = 0.0;
+
+  std::unique_ptr<btDefaultCollisionConfiguration> collision_config_;
+  std::unique_ptr<btCollisionDispatcher> dispatcher_;
+  std::unique_ptr<btBroadphaseInterface> broadphase_;
+  std::unique_ptr<btSequentialImpulseConstraintSolver> solver_;
+  std::unique_ptr<btDiscreteDynamicsWorld> world_;
+  std::unique_ptr<btCollisionShape> robot_shape_;
+
+  std::unordered_map<uint64_t, Chunk> chunks_;
+  std::unordered_map<RobotState*, std::unique_ptr<btRigidBody>> robots_;
+  std::unordered_map<DynamiteState*, std::unique_ptr<Fire>> fires_;
+  std::vector<Explosion> explosions_;
+  // The fires of UpdateParticles, indexable
+  std::vector<Fire*> updated_fires_;
+  // Created after the physics world, as it adds bodies to it
+  std::unique_ptr<GameWorld> game_;
+
+  void SpawnDynamites();
+  void ReplayInput();
+  void UpdateExplosions();
+  void UpdateParticles();
+
+  virtual void OnChunkLoaded(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls,
+                             std::unique_ptr<btCompoundShape> collision_shape) override;
+  virtual void OnChunkWallsReset(LabyrinthChunkCoord chunk,
+                                 const LabyrinthChunkWalls& walls) override {}
+  virtual void OnWallPartsRemoved(LabyrinthChunkCoord chunk,
+                                  const std::vector<WallPartHit>& parts) override {}
+  virtual void OnChunkUnloaded(LabyrinthChunkCoord chunk) override;
+  virtual btRigidBody* OnRobotAdded(RobotState* robot, const glm::dvec3& pos) override;
+  virtual void OnRobotRemoved(RobotState* robot) override;
+  virtual void OnDynamiteAdded(DynamiteState* dynamite) override;
+  virtual void OnDynamiteRemoved(DynamiteState* dynamite) override;
+  virtual void OnBlast(const Blast& blast) override;
+  virtual void OnPlayerHit() override { player_hit_count_++; }
+  virtual void OnBorderWallHit() override { border_wall_hit_count_++; }
+};
+
+#endif
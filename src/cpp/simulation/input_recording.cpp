@@ -0,0 +1,91 @@
+// Copyright (c) Tamas Csala
+
+#include <cstring>
+
+#include "simulation/input_recording.hpp"
+
+static const char kInputRecordingMagic[8] = {'P', 'Y', 'R', 'O', 'R', 'E', 'C', '\0'};
+static const uint32_t kInputRecordingVersion = 1;
+// Far more than the key events a player can make in one tick, a larger count
+// means the file is corrupt.
+static const uint32_t kMaxEventsPerTick = 4096;
+
+bool InputRecording::Read(const std::string& path) {
+  std::ifstream file{path, std::ios::binary};
+  InputRecordingHeader header;
+  if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+      std::memcmp(header.magic, kInputRecordingMagic, sizeof(header.magic)) != 0 ||
+      header.version != kInputRecordingVersion || header.timestep <= 0.0) {
+    return false;
+  }
+  seed = header.seed;
+  labyrinth_radius = header.labyrinth_radius;
+  timestep = header.timestep;
+
+  std::streamoff data_begin = file.tellg();
+  file.seekg(0, std::ios::end);
+  std::streamoff file_size = file.tellg();
+  file.seekg(data_begin);
+
+  ticks.clear();
+  InputTickHeader tick_header;
+  while (file.read(reinterpret_cast<char*>(&tick_header), sizeof(tick_header))) {
+    InputTick tick;
+    tick.camera_pos = glm::dvec3{tick_header.camera_pos[0], tick_header.camera_pos[1],
+                                 tick_header.camera_pos[2]};
+    tick.camera_forward = glm::dvec3{tick_header.camera_forward[0],
+                                     tick_header.camera_forward[1],
+                                     tick_header.camera_forward[2]};
+    if (tick_header.event_count > kMaxEventsPerTick) {
+      ticks.clear();
+      return false;
+    }
+    std::streamoff events_size = tick_header.event_count * std::streamoff(sizeof(InputEvent));
+    if (events_size > file_size - std::streamoff(file.tellg())) {
+      // Cut off in the middle of a tick, when the game crashed
+      break;
+    }
+    tick.events.resize(tick_header.event_count);
+    if (!file.read(reinterpret_cast<char*>(tick.events.data()), events_size)) {
+      break;
+    }
+    ticks.push_back(std::move(tick));
+  }
+  return true;
+}
+
+bool InputRecorder::Open(const std::string& path, uint64_t seed, int labyrinth_radius,
+                         double timestep) {
+  file_.open(path, std::ios::binary | std::ios::trunc);
+
+  InputRecordingHeader header = {};
+  std::memcpy(header.magic, kInputRecordingMagic, sizeof(header.magic));
+  header.version = kInputRecordingVersion;
+  header.labyrinth_radius = labyrinth_radius;
+  header.seed = seed;
+  header.timestep = timestep;
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  return file_.good();
+}
+
+void InputRecorder::RecordKey(int key, int scancode, int action, int mods) {
+  InputEvent event;
+  event.key = key;
+  event.scancode = scancode;
+  event.action = action;
+  event.mods = mods;
+  events_.push_back(event);
+}
+
+void InputRecorder::WriteTick(const glm::dvec3& camera_pos, const glm::dvec3& camera_forward) {
+  InputTickHeader header;
+  for (int i = 0; i < 3; ++i) {
+    header.camera_pos[i] = camera_pos[i];
+    header.camera_forward[i] = camera_forward[i];
+  }
+  header.event_count = events_.size();
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file_.write(reinterpret_cast<const char*>(events_.data()), events_.size() * sizeof(InputEvent));
+  events_.clear();
+  tick_count_++;
+}
@@ -0,0 +1,90 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_INPUT_RECORDING_HPP_
+#define SIMULATION_INPUT_RECORDING_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// The player's input of a game, recorded per simulation tick, so that the
+// game can be replayed with a fixed timestep. The layout of the file is:
+//   InputRecordingHeader
+//   per tick:
+//     InputTickHeader
+//     InputEvent[event_count]    the key events that arrived before the tick
+// In the byte order of the machine that wrote it.
+
+// The GLFW values that the headless replay acts on, the simulation doesn't
+// depend on GLFW.
+constexpr int kInputPress = 1;       // GLFW_PRESS
+constexpr int kInputKeySpace = 32;   // GLFW_KEY_SPACE
+constexpr int kInputKeyF1 = 290;     // GLFW_KEY_F1
+
+struct InputRecordingHeader {
+  char magic[8];
+  uint32_t version;
+  int32_t labyrinth_radius;
+  uint64_t seed;
+  double timestep;
+};
+
+// The player camera at the start of the tick, see RecordedVector.
+struct InputTickHeader {
+  float camera_pos[3];
+  float camera_forward[3];
+  uint32_t event_count;
+};
+
+struct InputEvent {
+  int16_t key;
+  int16_t scancode;
+  uint8_t action;
+  uint8_t mods;
+};
+
+struct InputTick {
+  glm::dvec3 camera_pos;
+  glm::dvec3 camera_forward;
+  std::vector<InputEvent> events;
+};
+
+// The recording game rounds the camera to the stored precision after every
+// update, so it sees the same as the replays.
+inline glm::dvec3 RecordedVector(const glm::dvec3& v) {
+  return glm::dvec3{glm::vec3{v}};
+}
+
+struct InputRecording {
+  uint64_t seed = 0;
+  int labyrinth_radius = 0;
+  double timestep = 0.0;
+  std::vector<InputTick> ticks;
+
+  // Returns false if the file can't be read, isn't a recording or is corrupt.
+  // A tick that was cut off at the end of the file is dropped.
+  bool Read(const std::string& path);
+};
+
+// Writes the ticks as they are recorded, a crash only loses the buffered ones.
+class InputRecorder {
+ public:
+  // Returns false if the file can't be created.
+  bool Open(const std::string& path, uint64_t seed, int labyrinth_radius, double timestep);
+
+  // Buffered until the next tick is written.
+  void RecordKey(int key, int scancode, int action, int mods);
+  // Writes a tick with the events recorded since the last one.
+  void WriteTick(const glm::dvec3& camera_pos, const glm::dvec3& camera_forward);
+
+  size_t tick_count() const { return tick_count_; }
+
+ private:
+  std::ofstream file_;
+  std::vector<InputEvent> events_;
+  size_t tick_count_ = 0;
+};
+
+#endif
@@ -0,0 +1,144 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+
+#include "simulation/job_system.hpp"
+#include "simulation/profiler.hpp"
+
+// The queue of the current thread, 0 for threads outside of any pool
+static thread_local size_t tls_queue_index = 0;
+static thread_local JobSystem* tls_job_system = nullptr;
+
+JobSystem::JobSystem(unsigned thread_count) {
+  if (thread_count == 0) {
+    thread_count = 1;
+  }
+
+  for (unsigned i = 0; i < thread_count; ++i) {
+    queues_.emplace_back(new Queue());
+  }
+  for (unsigned i = 1; i < thread_count; ++i) {
+    threads_.emplace_back(&JobSystem::WorkerMain, this, i);
+  }
+}
+
+JobSystem::~JobSystem() {
+  while (TryRunJob(0)) {}
+
+  {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    stop_ = true;
+  }
+  wake_up_.notify_all();
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void JobSystem::Submit(JobGroup* group, std::function<void()> job) {
+  group->pending_.fetch_add(1, std::memory_order_relaxed);
+
+  size_t queue_index = tls_job_system == this ? tls_queue_index : 0;
+  Queue& queue = *queues_[queue_index];
+  {
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    queue.jobs.push_back(Job{group, std::move(job)});
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{sleep_mutex_};
+    queued_job_count_++;
+  }
+  wake_up_.notify_one();
+}
+
+void JobSystem::Wait(JobGroup* group) {
+  size_t queue_index = tls_job_system == this ? tls_queue_index : 0;
+  while (!group->IsDone()) {
+    if (TryRunJob(queue_index)) {
+      continue;
+    }
+
+    // Every queue is empty, the rest of the group is running on the workers
+    std::unique_lock<std::mutex> lock{done_mutex_};
+    group_done_.wait(lock, [group] { return group->IsDone(); });
+  }
+}
+
+void JobSystem::ParallelFor(size_t count, const std::function<void(size_t, size_t)>& body) {
+  size_t slice_count = std::min<size_t>(thread_count(), count);
+  if (slice_count <= 1) {
+    if (count > 0) {
+      body(0, count);
+    }
+    return;
+  }
+
+  JobGroup group;
+  for (size_t i = 0; i < slice_count; ++i) {
+    size_t begin = count * i / slice_count, end = count * (i + 1) / slice_count;
+    Submit(&group, [&body, begin, end] { body(begin, end); });
+  }
+  Wait(&group);
+}
+
+bool JobSystem::PopJob(size_t queue_index, Job* job) {
+  // Own jobs are taken from the back (the most recent, hot in the cache)...
+  {
+    Queue& queue = *queues_[queue_index];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (!queue.jobs.empty()) {
+      *job = std::move(queue.jobs.back());
+      queue.jobs.pop_back();
+      return true;
+    }
+  }
+
+  // ... other's are stolen from the front.
+  for (size_t i = 1; i < queues_.size(); ++i) {
+    Queue& queue = *queues_[(queue_index + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock{queue.mutex};
+    if (!queue.jobs.empty()) {
+      *job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool JobSystem::TryRunJob(size_t queue_index) {
+  Job job;
+  if (!PopJob(queue_index, &job)) {
+    return false;
+  }
+  queued_job_count_--;
+
+  {
+    PYROMAZE_PROFILE_ZONE("Job");
+    job.function();
+  }
+  if (job.group->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    std::lock_guard<std::mutex> lock{done_mutex_};
+    group_done_.notify_all();
+  }
+  return true;
+}
+
+void JobSystem::WorkerMain(size_t queue_index) {
+  tls_queue_index = queue_index;
+  tls_job_system = this;
+
+  while (true) {
+    if (TryRunJob(queue_index)) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock{sleep_mutex_};
+    wake_up_.wait(lock, [this] { return stop_ || queued_job_count_ > 0; });
+    if (stop_) {
+      return;
+    }
+  }
+}
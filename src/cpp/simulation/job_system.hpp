@@ -0,0 +1,77 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_JOB_SYSTEM_HPP_
+#define SIMULATION_JOB_SYSTEM_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the unfinished jobs submitted with it.
+class JobGroup {
+ public:
+  bool IsDone() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+ private:
+  std::atomic<int> pending_{0};
+
+  friend class JobSystem;
+};
+
+// A work stealing thread pool. Every worker thread has its own job queue, it
+// takes its own jobs from the back, and steals from the front of the others'
+// queues when it runs out of work. The thread that waits for a group helps
+// executing the jobs meanwhile, and sleeps once there's nothing left to take.
+// A pool of one thread has no workers at all, and runs everything on the
+// waiting thread.
+class JobSystem {
+ public:
+  // thread_count includes the thread that submits and waits for the jobs.
+  explicit JobSystem(unsigned thread_count = std::thread::hardware_concurrency());
+  // Finishes the jobs that are still queued.
+  ~JobSystem();
+
+  unsigned thread_count() const { return threads_.size() + 1; }
+
+  void Submit(JobGroup* group, std::function<void()> job);
+  void Wait(JobGroup* group);
+
+  // Calls body(begin, end) on [0, count) split into one slice per thread, and
+  // waits for them. A pool of one thread calls it once, without a job.
+  void ParallelFor(size_t count, const std::function<void(size_t, size_t)>& body);
+
+ private:
+  struct Job {
+    JobGroup* group;
+    std::function<void()> function;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+  };
+
+  // queues_[0] is for the threads outside the pool, queues_[i] for worker i
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> threads_;
+
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_up_;
+  std::atomic<int> queued_job_count_{0};
+  bool stop_ = false;
+
+  // Notified when the last job of a group finishes
+  std::mutex done_mutex_;
+  std::condition_variable group_done_;
+
+  void WorkerMain(size_t queue_index);
+  bool TryRunJob(size_t queue_index);
+  bool PopJob(size_t queue_index, Job* job);
+};
+
+#endif
@@ -0,0 +1,18 @@
+// Copyright (c) Tamas Csala
+
+#include <cstdlib>
+
+#include "simulation/labyrinth.hpp"
+
+LabyrinthCell GenerateLabyrinthCell(int radius, const RandomStreams& random, int x, int z) {
+  Random cell_random = random.ForCell(RandomStream::kLabyrinth, x, z);
+  LabyrinthCell cell;
+  cell.x = x;
+  cell.z = z;
+  for (int i = 0; i < 4; ++i) {
+    cell.wall_parts[i] = cell_random.RandInt(4) != 0;
+  }
+  cell.has_robot = (abs(x) > 1 || abs(z) > 1) && x != radius
+                   && z != radius && cell_random.RandInt(2) == 0;
+  return cell;
+}
@@ -0,0 +1,25 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_LABYRINTH_HPP_
+#define SIMULATION_LABYRINTH_HPP_
+
+#include <array>
+
+#include "simulation/random.hpp"
+
+constexpr float kWallLength = 20;
+
+// One junction of the labyrinth. Wall parts are indexed like the
+// wall/wall{1..4}.obj meshes: +z, -x, -z, +x.
+struct LabyrinthCell {
+  int x, z;
+  std::array<bool, 4> wall_parts;
+  bool has_robot;
+};
+
+// Generates one cell of the labyrinth's layout, without any rendering or
+// physics objects. Every cell has its own random generator, so the layout only
+// depends on the seed, and any part of it can be generated on its own.
+LabyrinthCell GenerateLabyrinthCell(int radius, const RandomStreams& random, int x, int z);
+
+#endif
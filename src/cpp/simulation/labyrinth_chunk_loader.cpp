@@ -0,0 +1,92 @@
+// Copyright (c) Tamas Csala
+
+#include "simulation/labyrinth_chunk_loader.hpp"
+
+LabyrinthChunkLoader::LabyrinthChunkLoader(const LabyrinthGrid& grid,
+                                           const LabyrinthCollision& collision)
+    : grid_(grid)
+    , random_(grid.random())
+    , collision_(collision)
+    , thread_(&LabyrinthChunkLoader::ThreadMain, this) {
+}
+
+LabyrinthChunkLoader::~LabyrinthChunkLoader() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    stop_ = true;
+  }
+  wake_up_.notify_one();
+  thread_.join();
+}
+
+void LabyrinthChunkLoader::Request(LabyrinthChunkCoord chunk) {
+  const LabyrinthChunkRecord* record = grid_.GetRecord(chunk);
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    jobs_.push_back(Job{chunk, record != nullptr, record ? *record : LabyrinthChunkRecord{}});
+  }
+  wake_up_.notify_one();
+}
+
+std::vector<LabyrinthChunkBuild> LabyrinthChunkLoader::TakeFinished() {
+  std::lock_guard<std::mutex> lock{mutex_};
+  std::vector<LabyrinthChunkBuild> finished;
+  finished.swap(finished_);
+  return finished;
+}
+
+LabyrinthChunkBuild LabyrinthChunkLoader::Build(const LabyrinthGrid& grid,
+                                                const LabyrinthCollision& collision,
+                                                LabyrinthChunkCoord chunk) {
+  const LabyrinthChunkRecord* record = grid.GetRecord(chunk);
+  Job job{chunk, record != nullptr, record ? *record : LabyrinthChunkRecord{}};
+  return Build(grid.radius(), grid.random(), collision, job);
+}
+
+LabyrinthChunkBuild LabyrinthChunkLoader::Build(int radius, const RandomStreams& random,
+                                                const LabyrinthCollision& collision,
+                                                const Job& job) {
+  const LabyrinthChunkRecord* record = job.has_record ? &job.record : nullptr;
+
+  LabyrinthChunkBuild build;
+  build.chunk = job.chunk;
+  build.walls = LabyrinthGrid::GenerateChunkWalls(radius, random, job.chunk, record);
+  build.collision_shape = collision.BuildChunkShape(radius, job.chunk, build.walls);
+
+  for (int local_x = 0; local_x < kLabyrinthChunkSize; ++local_x) {
+    for (int local_z = 0; local_z < kLabyrinthChunkSize; ++local_z) {
+      int x = job.chunk.min_junction_x() + local_x;
+      int z = job.chunk.min_junction_z() + local_z;
+      if (std::abs(x) > radius || std::abs(z) > radius ||
+          !GenerateLabyrinthCell(radius, random, x, z).has_robot) {
+        continue;
+      }
+      int bit = LabyrinthChunkRecord::JunctionBit(local_x, local_z);
+      if (!record || !((record->killed_robots >> bit) & 1)) {
+        build.robots.push_back(GridCell(x, z));
+      }
+    }
+  }
+
+  return build;
+}
+
+void LabyrinthChunkLoader::ThreadMain() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      wake_up_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+      if (stop_) {
+        return;
+      }
+      job = jobs_.front();
+      jobs_.pop_front();
+    }
+
+    LabyrinthChunkBuild build = Build(grid_.radius(), random_, collision_, job);
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    finished_.push_back(std::move(build));
+  }
+}
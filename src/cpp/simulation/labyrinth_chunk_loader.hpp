@@ -0,0 +1,79 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_LABYRINTH_CHUNK_LOADER_HPP_
+#define SIMULATION_LABYRINTH_CHUNK_LOADER_HPP_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "simulation/labyrinth_collision.hpp"
+#include "simulation/labyrinth_grid.hpp"
+#include "simulation/spatial_grid.hpp"
+
+// The chunks within kChunkLoadRadius chunks (on both axes) of the player's
+// chunk are loaded, and the ones further than kChunkUnloadRadius are
+// unloaded, the difference avoids reloading a chunk at every step over a
+// chunk border.
+constexpr int kChunkLoadRadius = 2;
+constexpr int kChunkUnloadRadius = 3;
+
+inline int ChunkDistance(LabyrinthChunkCoord a, LabyrinthChunkCoord b) {
+  return std::max(std::abs(a.x - b.x), std::abs(a.z - b.z));
+}
+
+// The parts of a chunk that don't need the scene or OpenGL.
+struct LabyrinthChunkBuild {
+  LabyrinthChunkCoord chunk;
+  LabyrinthChunkWalls walls;
+  // The junctions whose room (towards +x, +z) has a live robot
+  std::vector<GridCell> robots;
+  std::unique_ptr<btCompoundShape> collision_shape;
+};
+
+// Builds labyrinth chunks on a background thread. Request copies the state
+// that the build needs from the grid, so the thread never touches it.
+class LabyrinthChunkLoader {
+ public:
+  // The grid and the collision must outlive the loader.
+  LabyrinthChunkLoader(const LabyrinthGrid& grid, const LabyrinthCollision& collision);
+  ~LabyrinthChunkLoader();
+
+  // Should be called from the thread that owns the grid.
+  void Request(LabyrinthChunkCoord chunk);
+  std::vector<LabyrinthChunkBuild> TakeFinished();
+
+  // Builds the chunk on the calling thread.
+  static LabyrinthChunkBuild Build(const LabyrinthGrid& grid, const LabyrinthCollision& collision,
+                                   LabyrinthChunkCoord chunk);
+
+ private:
+  struct Job {
+    LabyrinthChunkCoord chunk;
+    bool has_record;
+    LabyrinthChunkRecord record;
+  };
+
+  const LabyrinthGrid& grid_;
+  RandomStreams random_;
+  const LabyrinthCollision& collision_;
+
+  std::mutex mutex_;
+  std::condition_variable wake_up_;
+  std::deque<Job> jobs_;
+  std::vector<LabyrinthChunkBuild> finished_;
+  bool stop_ = false;
+  std::thread thread_;
+
+  static LabyrinthChunkBuild Build(int radius, const RandomStreams& random,
+                                   const LabyrinthCollision& collision,
+                                   const Job& job);
+  void ThreadMain();
+};
+
+#endif
@@ -0,0 +1,75 @@
+// Copyright (c) Tamas Csala
+
+#include <cstdlib>
+
+#include "simulation/labyrinth_collision.hpp"
+
+LabyrinthCollision::LabyrinthCollision()
+    : pillar_bounds_(LoadMeshObjectBounds("src/resource/wall/pillars.obj")) {
+  for (const Aabb& bb : pillar_bounds_) {
+    pillar_shapes_.push_back(AddBoxShape(bb));
+  }
+  for (int i = 0; i < 4; ++i) {
+    wall_part_bounds_[i] = LoadMeshBounds("src/resource/wall/wall" + std::to_string(i+1) + ".obj");
+    wall_part_shapes_[i] = AddBoxShape(wall_part_bounds_[i]);
+  }
+  for (int i = 0; i < 2; ++i) {
+    border_wall_bounds_[i] = LoadMeshBounds("src/resource/wall/bigwall" + std::to_string(i+1) + ".obj");
+    border_wall_shapes_[i] = AddBoxShape(border_wall_bounds_[i]);
+  }
+}
+
+btCollisionShape* LabyrinthCollision::AddBoxShape(const Aabb& bb) {
+  glm::vec3 half_extent = bb.GetExtent() / 2.0f;
+  shapes_.emplace_back(new btBoxShape(btVector3(half_extent.x, half_extent.y, half_extent.z)));
+  return shapes_.back().get();
+}
+
+std::unique_ptr<btCompoundShape> LabyrinthCollision::BuildChunkShape(
+    int radius, LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls) const {
+  std::unique_ptr<btCompoundShape> shape{new btCompoundShape()};
+  RebuildChunkShape(radius, chunk, walls, shape.get());
+  return shape;
+}
+
+static void AddChild(btCompoundShape* compound, btCollisionShape* shape, const glm::vec3& pos) {
+  btTransform transform;
+  transform.setIdentity();
+  transform.setOrigin(btVector3(pos.x, pos.y, pos.z));
+  compound->addChildShape(transform, shape);
+}
+
+void LabyrinthCollision::RebuildChunkShape(int radius, LabyrinthChunkCoord chunk,
+                                           const LabyrinthChunkWalls& walls,
+                                           btCompoundShape* shape) const {
+  for (int i = shape->getNumChildShapes() - 1; i >= 0; --i) {
+    shape->removeChildShapeByIndex(i);
+  }
+
+  int border_radius = radius + 1;
+  for (int local_x = 0; local_x < kLabyrinthChunkSize; ++local_x) {
+    for (int local_z = 0; local_z < kLabyrinthChunkSize; ++local_z) {
+      int x = chunk.min_junction_x() + local_x, z = chunk.min_junction_z() + local_z;
+      glm::vec3 junction_pos = LabyrinthGrid::GetJunctionPos(x, z);
+      if (std::abs(x) <= radius && std::abs(z) <= radius) {
+        for (size_t i = 0; i < pillar_shapes_.size(); ++i) {
+          AddChild(shape, pillar_shapes_[i], junction_pos + pillar_bounds_[i].GetCenter());
+        }
+        uint8_t parts = walls.Get(local_x, local_z);
+        for (int i = 0; i < 4; ++i) {
+          if ((parts >> i) & 1) {
+            AddChild(shape, wall_part_shapes_[i], junction_pos + wall_part_bounds_[i].GetCenter());
+          }
+        }
+      } else if (std::abs(x) <= border_radius && std::abs(z) <= border_radius) {
+        // The border walls are placed like the meshes of LabyrinthChunk
+        if (std::abs(z) == border_radius) {
+          AddChild(shape, border_wall_shapes_[0], junction_pos + border_wall_bounds_[0].GetCenter());
+        }
+        if (std::abs(x) == border_radius) {
+          AddChild(shape, border_wall_shapes_[1], junction_pos + border_wall_bounds_[1].GetCenter());
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,48 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_LABYRINTH_COLLISION_HPP_
+#define SIMULATION_LABYRINTH_COLLISION_HPP_
+
+#include <memory>
+#include <vector>
+#include <btBulletDynamicsCommon.h>
+
+#include "simulation/labyrinth_grid.hpp"
+#include "simulation/mesh_cache.hpp"
+
+// The static collision geometry of the labyrinth's pillars, wall parts and
+// border walls, made of boxes that are fitted to the bounds of the meshes
+// (read from the mesh cache if it is up to date).
+// Every chunk is a single compound shape, so the broadphase only has a proxy
+// per chunk, and destroying a wall part only rebuilds its own chunk.
+// The box shapes are owned by this object, so it has to outlive the
+// compounds. The children of the compounds are in world space, so their
+// collision objects should have identity transform.
+class LabyrinthCollision {
+ public:
+  LabyrinthCollision();
+
+  // Thread safe
+  std::unique_ptr<btCompoundShape> BuildChunkShape(int radius, LabyrinthChunkCoord chunk,
+                                                   const LabyrinthChunkWalls& walls) const;
+
+  // Refills the compound, so the collision objects can keep using it.
+  void RebuildChunkShape(int radius, LabyrinthChunkCoord chunk,
+                         const LabyrinthChunkWalls& walls, btCompoundShape* shape) const;
+
+  // Relative to the junction's position
+  glm::vec3 GetWallPartCenter(int part) const { return wall_part_bounds_[part].GetCenter(); }
+
+ private:
+  std::vector<std::unique_ptr<btCollisionShape>> shapes_;
+  std::vector<Aabb> pillar_bounds_;
+  std::vector<btCollisionShape*> pillar_shapes_;
+  Aabb wall_part_bounds_[4];
+  btCollisionShape* wall_part_shapes_[4];
+  Aabb border_wall_bounds_[2];
+  btCollisionShape* border_wall_shapes_[2];
+
+  btCollisionShape* AddBoxShape(const Aabb& bb);
+};
+
+#endif
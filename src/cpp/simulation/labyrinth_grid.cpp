@@ -0,0 +1,133 @@
+// Copyright (c) Tamas Csala
+
+#include "simulation/labyrinth_grid.hpp"
+
+static uint8_t GeneratedWallParts(int radius, const RandomStreams& random, int x, int z) {
+  LabyrinthCell cell = GenerateLabyrinthCell(radius, random, x, z);
+  uint8_t parts = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (cell.wall_parts[i]) {
+      parts |= 1 << i;
+    }
+  }
+  return parts;
+}
+
+LabyrinthGrid::LabyrinthGrid(int radius, const RandomStreams& random)
+    : radius_(radius), random_(random) {
+}
+
+size_t LabyrinthGrid::memory_usage() const {
+  // Roughly, with a node and a bucket per element of the hash maps
+  size_t node_overhead = 2 * sizeof(void*) + sizeof(uint64_t);
+  return sizeof(*this) +
+         loaded_chunks_.size() * (sizeof(LabyrinthChunkWalls) + node_overhead) +
+         records_.size() * (sizeof(LabyrinthChunkRecord) + node_overhead);
+}
+
+uint8_t LabyrinthGrid::GetWallParts(int x, int z) const {
+  if (!IsInside(x, z)) {
+    return 0;
+  }
+
+  LabyrinthChunkCoord chunk = LabyrinthChunkCoord::FromJunction(x, z);
+  int local_x = x - chunk.min_junction_x(), local_z = z - chunk.min_junction_z();
+  auto loaded = loaded_chunks_.find(chunk.Key());
+  if (loaded != loaded_chunks_.end()) {
+    return loaded->second.Get(local_x, local_z);
+  }
+
+  uint8_t parts = GeneratedWallParts(radius_, random_, x, z);
+  const LabyrinthChunkRecord* record = GetRecord(chunk);
+  if (record) {
+    parts &= ~record->destroyed_wall_parts.Get(local_x, local_z);
+  }
+  return parts;
+}
+
+bool LabyrinthGrid::RemoveWallPart(int x, int z, int part) {
+  if (!HasWallPart(x, z, part)) {
+    return false;
+  }
+
+  LabyrinthChunkCoord chunk = LabyrinthChunkCoord::FromJunction(x, z);
+  int local_x = x - chunk.min_junction_x(), local_z = z - chunk.min_junction_z();
+  LabyrinthChunkWalls& destroyed = records_[chunk.Key()].destroyed_wall_parts;
+  destroyed.Set(local_x, local_z, destroyed.Get(local_x, local_z) | (1 << part));
+
+  auto loaded = loaded_chunks_.find(chunk.Key());
+  if (loaded != loaded_chunks_.end()) {
+    LabyrinthChunkWalls& walls = loaded->second;
+    walls.Set(local_x, local_z, walls.Get(local_x, local_z) & ~(1 << part));
+  }
+
+  destroyed_wall_part_count_++;
+  return true;
+}
+
+bool LabyrinthGrid::HasRobot(int x, int z) const {
+  if (!IsInside(x, z) || !GenerateLabyrinthCell(radius_, random_, x, z).has_robot) {
+    return false;
+  }
+
+  LabyrinthChunkCoord chunk = LabyrinthChunkCoord::FromJunction(x, z);
+  const LabyrinthChunkRecord* record = GetRecord(chunk);
+  int bit = LabyrinthChunkRecord::JunctionBit(x - chunk.min_junction_x(),
+                                              z - chunk.min_junction_z());
+  return !record || !((record->killed_robots >> bit) & 1);
+}
+
+void LabyrinthGrid::RecordRobotKilled(int x, int z) {
+  LabyrinthChunkCoord chunk = LabyrinthChunkCoord::FromJunction(x, z);
+  int bit = LabyrinthChunkRecord::JunctionBit(x - chunk.min_junction_x(),
+                                              z - chunk.min_junction_z());
+  records_[chunk.Key()].killed_robots |= uint64_t(1) << bit;
+}
+
+const LabyrinthChunkWalls* LabyrinthGrid::GetLoadedChunk(LabyrinthChunkCoord chunk) const {
+  auto iter = loaded_chunks_.find(chunk.Key());
+  return iter != loaded_chunks_.end() ? &iter->second : nullptr;
+}
+
+const LabyrinthChunkRecord* LabyrinthGrid::GetRecord(LabyrinthChunkCoord chunk) const {
+  auto iter = records_.find(chunk.Key());
+  return iter != records_.end() ? &iter->second : nullptr;
+}
+
+LabyrinthChunkWalls LabyrinthGrid::GenerateChunkWalls(int radius, const RandomStreams& random,
+                                                      LabyrinthChunkCoord chunk,
+                                                      const LabyrinthChunkRecord* record) {
+  LabyrinthChunkWalls walls;
+  for (int local_x = 0; local_x < kLabyrinthChunkSize; ++local_x) {
+    for (int local_z = 0; local_z < kLabyrinthChunkSize; ++local_z) {
+      int x = chunk.min_junction_x() + local_x, z = chunk.min_junction_z() + local_z;
+      if (-radius <= x && x <= radius && -radius <= z && z <= radius) {
+        uint8_t parts = GeneratedWallParts(radius, random, x, z);
+        if (record) {
+          parts &= ~record->destroyed_wall_parts.Get(local_x, local_z);
+        }
+        walls.Set(local_x, local_z, parts);
+      }
+    }
+  }
+  return walls;
+}
+
+void LabyrinthGrid::LoadChunk(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls) {
+  LabyrinthChunkWalls& loaded = loaded_chunks_[chunk.Key()];
+  loaded = walls;
+
+  const LabyrinthChunkRecord* record = GetRecord(chunk);
+  if (record) {
+    for (int local_x = 0; local_x < kLabyrinthChunkSize; ++local_x) {
+      for (int local_z = 0; local_z < kLabyrinthChunkSize; ++local_z) {
+        loaded.Set(local_x, local_z, loaded.Get(local_x, local_z) &
+                                     ~record->destroyed_wall_parts.Get(local_x, local_z));
+      }
+    }
+  }
+}
+
+void LabyrinthGrid::UnloadChunk(LabyrinthChunkCoord chunk) {
+  loaded_chunks_.erase(chunk.Key());
+}
@@ -0,0 +1,156 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_LABYRINTH_GRID_HPP_
+#define SIMULATION_LABYRINTH_GRID_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#include "simulation/labyrinth.hpp"
+
+// The junctions are grouped into chunks of kLabyrinthChunkSize x
+// kLabyrinthChunkSize, chunk (x, z) holds the junctions from (x, z) *
+// kLabyrinthChunkSize. The border walls are in the chunks too.
+constexpr int kLabyrinthChunkSize = 8;
+
+struct LabyrinthChunkCoord {
+  int x, z;
+
+  static LabyrinthChunkCoord FromJunction(int junction_x, int junction_z) {
+    return LabyrinthChunkCoord{FloorDiv(junction_x), FloorDiv(junction_z)};
+  }
+
+  int min_junction_x() const { return x * kLabyrinthChunkSize; }
+  int min_junction_z() const { return z * kLabyrinthChunkSize; }
+
+  uint64_t Key() const { return (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(z)); }
+
+  bool operator==(const LabyrinthChunkCoord& other) const { return x == other.x && z == other.z; }
+  bool operator!=(const LabyrinthChunkCoord& other) const { return !(*this == other); }
+
+ private:
+  static int FloorDiv(int value) {
+    return value >= 0 ? value / kLabyrinthChunkSize
+                      : -((-value + kLabyrinthChunkSize - 1) / kLabyrinthChunkSize);
+  }
+};
+
+// Four bits per junction of a chunk (two junctions a byte), indexed like
+// LabyrinthCell::wall_parts.
+class LabyrinthChunkWalls {
+ public:
+  uint8_t Get(int local_x, int local_z) const {
+    int index = local_x * kLabyrinthChunkSize + local_z;
+    return (bits_[index / 2] >> (4 * (index % 2))) & 0xF;
+  }
+
+  void Set(int local_x, int local_z, uint8_t parts) {
+    int index = local_x * kLabyrinthChunkSize + local_z;
+    uint8_t shift = 4 * (index % 2);
+    bits_[index / 2] = (bits_[index / 2] & ~(0xF << shift)) | ((parts & 0xF) << shift);
+  }
+
+  bool operator==(const LabyrinthChunkWalls& other) const { return bits_ == other.bits_; }
+  bool operator!=(const LabyrinthChunkWalls& other) const { return bits_ != other.bits_; }
+
+ private:
+  std::array<uint8_t, kLabyrinthChunkSize * kLabyrinthChunkSize / 2> bits_{};
+};
+
+// Everything that the player changed in a chunk, so it survives the chunk
+// being unloaded. Only exists for the chunks that had any change.
+struct LabyrinthChunkRecord {
+  LabyrinthChunkWalls destroyed_wall_parts;
+  uint64_t killed_robots = 0;  // a bit per junction
+
+  static int JunctionBit(int local_x, int local_z) {
+    return local_x * kLabyrinthChunkSize + local_z;
+  }
+};
+
+// The state of the labyrinth's walls. The original layout is generated from
+// the seed (per junction), the loaded chunks cache their walls as packed
+// bits, and the changes are kept in a LabyrinthChunkRecord per chunk, so any
+// junction can be queried, whether its chunk is loaded or not.
+// Not thread safe, the chunk loader thread uses GenerateChunkWalls instead.
+class LabyrinthGrid {
+ public:
+  LabyrinthGrid(int radius, const RandomStreams& random);
+
+  int radius() const { return radius_; }
+  const RandomStreams& random() const { return random_; }
+  size_t destroyed_wall_part_count() const { return destroyed_wall_part_count_; }
+  size_t loaded_chunk_count() const { return loaded_chunks_.size(); }
+  size_t memory_usage() const;
+
+  bool IsInside(int x, int z) const {
+    return -radius_ <= x && x <= radius_ && -radius_ <= z && z <= radius_;
+  }
+
+  // The bits of the wall parts, indexed like LabyrinthCell::wall_parts, or 0
+  // outside the labyrinth.
+  uint8_t GetWallParts(int x, int z) const;
+
+  bool HasWallPart(int x, int z, int part) const {
+    return (GetWallParts(x, z) >> part) & 1;
+  }
+
+  // Returns false if the part didn't exist.
+  bool RemoveWallPart(int x, int z, int part);
+
+  // The robot that is generated in the room next to (+x, +z) the junction.
+  bool HasRobot(int x, int z) const;
+  void RecordRobotKilled(int x, int z);
+
+  // The cached walls of a loaded chunk, nullptr if it isn't loaded.
+  const LabyrinthChunkWalls* GetLoadedChunk(LabyrinthChunkCoord chunk) const;
+
+  // The record of the chunk's changes, nullptr if it has none.
+  const LabyrinthChunkRecord* GetRecord(LabyrinthChunkCoord chunk) const;
+
+  // The current walls of a chunk, from the seed and the record.
+  static LabyrinthChunkWalls GenerateChunkWalls(int radius, const RandomStreams& random,
+                                                LabyrinthChunkCoord chunk,
+                                                const LabyrinthChunkRecord* record);
+
+  // Caches the walls of a chunk while it's loaded. The walls are reapplied
+  // with the current record, in case it changed while they were generated.
+  void LoadChunk(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls);
+  void UnloadChunk(LabyrinthChunkCoord chunk);
+
+  static glm::vec3 GetJunctionPos(int x, int z) {
+    return glm::vec3{x * kWallLength, -0.5f, z * kWallLength};
+  }
+
+  // Calls visitor(x, z) for the junctions within radius around center (on
+  // the xz plane), that are inside the labyrinth.
+  template<typename Visitor>
+  void ForEachJunctionInRadius(const glm::dvec3& center, double radius,
+                               Visitor visitor) const {
+    int min_x = std::max(-radius_, static_cast<int>(std::ceil((center.x - radius) / kWallLength)));
+    int max_x = std::min(radius_, static_cast<int>(std::floor((center.x + radius) / kWallLength)));
+    int min_z = std::max(-radius_, static_cast<int>(std::ceil((center.z - radius) / kWallLength)));
+    int max_z = std::min(radius_, static_cast<int>(std::floor((center.z + radius) / kWallLength)));
+    for (int x = min_x; x <= max_x; ++x) {
+      for (int z = min_z; z <= max_z; ++z) {
+        double dx = x * kWallLength - center.x, dz = z * kWallLength - center.z;
+        if (dx*dx + dz*dz <= radius*radius) {
+          visitor(x, z);
+        }
+      }
+    }
+  }
+
+ private:
+  int radius_;
+  RandomStreams random_;
+  size_t destroyed_wall_part_count_ = 0;
+  std::unordered_map<uint64_t, LabyrinthChunkWalls> loaded_chunks_;
+  std::unordered_map<uint64_t, LabyrinthChunkRecord> records_;
+};
+
+#endif
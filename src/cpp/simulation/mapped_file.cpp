@@ -0,0 +1,105 @@
+// Copyright (c) Tamas Csala
+
+#include <sys/stat.h>
+
+#ifdef _WIN32
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+#include "simulation/mapped_file.hpp"
+
+bool FileStamp::Read(const std::string& path) {
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    return false;
+  }
+  size = info.st_size;
+  mtime = info.st_mtime;
+  return true;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path) {
+  Close();
+  file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file_ == INVALID_HANDLE_VALUE) {
+    file_ = nullptr;
+    return false;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) {
+    Close();
+    return false;
+  }
+  mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping_) {
+    Close();
+    return false;
+  }
+  data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+  if (!data_) {
+    Close();
+    return false;
+  }
+  size_ = size.QuadPart;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+    data_ = nullptr;
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+    mapping_ = nullptr;
+  }
+  if (file_) {
+    CloseHandle(file_);
+    file_ = nullptr;
+  }
+  size_ = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path) {
+  Close();
+  file_ = open(path.c_str(), O_RDONLY);
+  if (file_ < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(file_, &info) != 0 || info.st_size == 0) {
+    Close();
+    return false;
+  }
+  void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file_, 0);
+  if (data == MAP_FAILED) {
+    Close();
+    return false;
+  }
+  data_ = static_cast<const unsigned char*>(data);
+  size_ = info.st_size;
+  return true;
+}
+
+void MappedFile::Close() {
+  if (data_) {
+    munmap(const_cast<unsigned char*>(data_), size_);
+    data_ = nullptr;
+  }
+  if (file_ >= 0) {
+    close(file_);
+    file_ = -1;
+  }
+  size_ = 0;
+}
+
+#endif
@@ -0,0 +1,52 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_MAPPED_FILE_HPP_
+#define SIMULATION_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// A read-only memory mapping of a whole file.
+class MappedFile {
+ public:
+  MappedFile() = default;
+  ~MappedFile() { Close(); }
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // Returns false if the file doesn't exist, is empty or can't be mapped.
+  bool Open(const std::string& path);
+  void Close();
+
+  const unsigned char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  const unsigned char* data_ = nullptr;
+  size_t size_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* mapping_ = nullptr;
+#else
+  int file_ = -1;
+#endif
+};
+
+// The size and modification time of a file, the caches that are generated
+// from a file store these to find out if they are stale.
+struct FileStamp {
+  uint64_t size;
+  int64_t mtime;
+
+  // Returns false if the file doesn't exist.
+  bool Read(const std::string& path);
+
+  bool operator==(const FileStamp& other) const {
+    return size == other.size && mtime == other.mtime;
+  }
+  bool operator!=(const FileStamp& other) const { return !(*this == other); }
+};
+
+#endif
@@ -0,0 +1,198 @@
+// Copyright (c) Tamas Csala
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "simulation/mesh_cache.hpp"
+
+static const char kMeshCacheMagic[8] = {'P', 'Y', 'R', 'O', 'M', 'E', 'S', 'H'};
+static const uint32_t kMeshCacheVersion = 1;
+
+// An .obj index is 1 based, or relative to the end if it's negative.
+static int ResolveObjIndex(int index, size_t count) {
+  return index > 0 ? index - 1 : static_cast<int>(count) + index;
+}
+
+ObjMesh ParseObjMesh(const std::string& obj_path) {
+  std::ifstream file{obj_path};
+  if (!file.is_open()) {
+    throw std::runtime_error("Couldn't open " + obj_path);
+  }
+
+  std::vector<glm::vec3> positions, normals;
+  std::vector<glm::vec2> tex_coords;
+  ObjMesh mesh;
+  std::unordered_map<std::string, uint32_t> vertex_indices;
+  bool has_vertex = false;
+
+  std::string line;
+  std::vector<uint32_t> polygon;
+  while (std::getline(file, line)) {
+    if (line.size() < 2) {
+      continue;
+    }
+    std::istringstream stream{line.substr(2)};
+    if (line[0] == 'o' && line[1] == ' ') {
+      has_vertex = false;
+    } else if (line[0] == 'v' && line[1] == ' ') {
+      glm::vec3 v;
+      stream >> v.x >> v.y >> v.z;
+      positions.push_back(v);
+      if (!has_vertex) {
+        mesh.object_bounds.push_back(Aabb{v, v});
+        has_vertex = true;
+      } else {
+        mesh.object_bounds.back().min = glm::min(mesh.object_bounds.back().min, v);
+        mesh.object_bounds.back().max = glm::max(mesh.object_bounds.back().max, v);
+      }
+    } else if (line.compare(0, 3, "vn ") == 0) {
+      std::istringstream normal_stream{line.substr(3)};
+      glm::vec3 n;
+      normal_stream >> n.x >> n.y >> n.z;
+      normals.push_back(n);
+    } else if (line.compare(0, 3, "vt ") == 0) {
+      std::istringstream tex_coord_stream{line.substr(3)};
+      glm::vec2 t;
+      tex_coord_stream >> t.x >> t.y;
+      tex_coords.push_back(t);
+    } else if (line[0] == 'f' && line[1] == ' ') {
+      polygon.clear();
+      std::string corner;
+      while (stream >> corner) {
+        auto iter = vertex_indices.find(corner);
+        if (iter != vertex_indices.end()) {
+          polygon.push_back(iter->second);
+          continue;
+        }
+
+        // v, v/vt, v//vn or v/vt/vn
+        int v = 0, vt = 0, vn = 0;
+        if (std::sscanf(corner.c_str(), "%d/%d/%d", &v, &vt, &vn) != 3 &&
+            std::sscanf(corner.c_str(), "%d//%d", &v, &vn) != 2 &&
+            std::sscanf(corner.c_str(), "%d/%d", &v, &vt) != 2 &&
+            std::sscanf(corner.c_str(), "%d", &v) != 1) {
+          throw std::runtime_error("Invalid face in " + obj_path + ": " + line);
+        }
+
+        MeshVertex vertex = {};
+        glm::vec3 position = positions.at(ResolveObjIndex(v, positions.size()));
+        std::memcpy(vertex.position, &position, sizeof(vertex.position));
+        if (vn != 0) {
+          glm::vec3 normal = normals.at(ResolveObjIndex(vn, normals.size()));
+          std::memcpy(vertex.normal, &normal, sizeof(vertex.normal));
+        }
+        if (vt != 0) {
+          glm::vec2 tex_coord = tex_coords.at(ResolveObjIndex(vt, tex_coords.size()));
+          std::memcpy(vertex.tex_coord, &tex_coord, sizeof(vertex.tex_coord));
+        }
+        uint32_t index = mesh.vertices.size();
+        mesh.vertices.push_back(vertex);
+        vertex_indices[corner] = index;
+        polygon.push_back(index);
+      }
+
+      // Triangle fan
+      for (size_t i = 2; i < polygon.size(); ++i) {
+        mesh.indices.push_back(polygon[0]);
+        mesh.indices.push_back(polygon[i-1]);
+        mesh.indices.push_back(polygon[i]);
+      }
+    }
+  }
+
+  return mesh;
+}
+
+std::string MeshCachePath(const std::string& obj_path) {
+  return obj_path + ".meshcache";
+}
+
+bool WriteMeshCache(const std::string& obj_path, const ObjMesh& mesh) {
+  MeshCacheHeader header = {};
+  std::memcpy(header.magic, kMeshCacheMagic, sizeof(header.magic));
+  header.version = kMeshCacheVersion;
+  header.object_count = mesh.object_bounds.size();
+  header.vertex_count = mesh.vertices.size();
+  header.index_count = mesh.indices.size();
+  if (!header.source.Read(obj_path)) {
+    return false;
+  }
+  if (!mesh.object_bounds.empty()) {
+    header.bounds = mesh.object_bounds[0];
+    for (const Aabb& bb : mesh.object_bounds) {
+      header.bounds.min = glm::min(header.bounds.min, bb.min);
+      header.bounds.max = glm::max(header.bounds.max, bb.max);
+    }
+  }
+
+  std::ofstream file{MeshCachePath(obj_path), std::ios::binary | std::ios::trunc};
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(mesh.object_bounds.data()),
+             mesh.object_bounds.size() * sizeof(Aabb));
+  file.write(reinterpret_cast<const char*>(mesh.vertices.data()),
+             mesh.vertices.size() * sizeof(MeshVertex));
+  file.write(reinterpret_cast<const char*>(mesh.indices.data()),
+             mesh.indices.size() * sizeof(uint32_t));
+  return file.good();
+}
+
+std::unique_ptr<MappedMeshCache> MappedMeshCache::Open(const std::string& obj_path) {
+  std::unique_ptr<MappedMeshCache> cache{new MappedMeshCache{}};
+  if (!cache->file_.Open(MeshCachePath(obj_path)) ||
+      cache->file_.size() < sizeof(MeshCacheHeader)) {
+    return nullptr;
+  }
+
+  const MeshCacheHeader& header = cache->header();
+  FileStamp source;
+  if (std::memcmp(header.magic, kMeshCacheMagic, sizeof(header.magic)) != 0 ||
+      header.version != kMeshCacheVersion ||
+      !source.Read(obj_path) || header.source != source) {
+    return nullptr;
+  }
+
+  size_t expected_size = sizeof(MeshCacheHeader) + header.object_count * sizeof(Aabb) +
+                         header.vertex_count * sizeof(MeshVertex) +
+                         header.index_count * sizeof(uint32_t);
+  if (cache->file_.size() != expected_size) {
+    return nullptr;
+  }
+
+  return cache;
+}
+
+const Aabb* MappedMeshCache::object_bounds() const {
+  return reinterpret_cast<const Aabb*>(file_.data() + sizeof(MeshCacheHeader));
+}
+
+const MeshVertex* MappedMeshCache::vertices() const {
+  return reinterpret_cast<const MeshVertex*>(object_bounds() + header().object_count);
+}
+
+const uint32_t* MappedMeshCache::indices() const {
+  return reinterpret_cast<const uint32_t*>(vertices() + header().vertex_count);
+}
+
+std::vector<Aabb> LoadMeshObjectBounds(const std::string& obj_path) {
+  std::unique_ptr<MappedMeshCache> cache = MappedMeshCache::Open(obj_path);
+  if (!cache) {
+    return LoadObjObjectBounds(obj_path);
+  }
+  return std::vector<Aabb>(cache->object_bounds(),
+                           cache->object_bounds() + cache->header().object_count);
+}
+
+Aabb LoadMeshBounds(const std::string& obj_path) {
+  std::unique_ptr<MappedMeshCache> cache = MappedMeshCache::Open(obj_path);
+  if (!cache) {
+    return LoadObjBounds(obj_path);
+  }
+  if (cache->header().object_count == 0) {
+    throw std::runtime_error(obj_path + " has no vertices");
+  }
+  return cache->header().bounds;
+}
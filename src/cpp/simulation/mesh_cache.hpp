@@ -0,0 +1,79 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_MESH_CACHE_HPP_
+#define SIMULATION_MESH_CACHE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulation/mapped_file.hpp"
+#include "simulation/obj_bounds.hpp"
+
+// A binary version of an .obj file, written by the pyromaze_mesh_cache tool
+// next to the .obj (path + ".meshcache"). The layout of the file is:
+//   MeshCacheHeader
+//   Aabb[object_count]          the bounds of the 'o' objects, that the
+//                               collision boxes are fitted to
+//   MeshVertex[vertex_count]    interleaved, ready to be uploaded
+//   uint32_t[index_count]       triangles
+// Everything is 4 byte aligned, in the byte order of the machine that wrote it.
+
+struct MeshVertex {
+  float position[3];
+  float normal[3];
+  float tex_coord[2];
+};
+
+struct MeshCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t object_count;
+  uint32_t vertex_count;
+  uint32_t index_count;
+  // The .obj that the cache was made from, a different one makes it stale
+  FileStamp source;
+  Aabb bounds;
+};
+
+// The parsed .obj, what the cache stores.
+struct ObjMesh {
+  std::vector<Aabb> object_bounds;
+  std::vector<MeshVertex> vertices;
+  std::vector<uint32_t> indices;
+};
+
+// Triangulates the polygons, and merges the identical vertices.
+ObjMesh ParseObjMesh(const std::string& obj_path);
+
+std::string MeshCachePath(const std::string& obj_path);
+
+// Returns false if the .obj can't be read or the cache can't be written.
+bool WriteMeshCache(const std::string& obj_path, const ObjMesh& mesh);
+
+// A read-only memory mapping of a mesh cache file.
+class MappedMeshCache {
+ public:
+  // Returns nullptr if the cache doesn't exist, or it's stale or corrupt.
+  static std::unique_ptr<MappedMeshCache> Open(const std::string& obj_path);
+
+  const MeshCacheHeader& header() const {
+    return *reinterpret_cast<const MeshCacheHeader*>(file_.data());
+  }
+  const Aabb* object_bounds() const;
+  const MeshVertex* vertices() const;
+  const uint32_t* indices() const;
+
+ private:
+  MappedFile file_;
+
+  MappedMeshCache() = default;
+};
+
+// LoadObjObjectBounds, from the cache if it's up to date.
+std::vector<Aabb> LoadMeshObjectBounds(const std::string& obj_path);
+// LoadObjBounds, from the cache if it's up to date.
+Aabb LoadMeshBounds(const std::string& obj_path);
+
+#endif
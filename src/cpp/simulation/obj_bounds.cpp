@@ -0,0 +1,53 @@
+// Copyright (c) Tamas Csala
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "simulation/obj_bounds.hpp"
+
+std::vector<Aabb> LoadObjObjectBounds(const std::string& path) {
+  std::ifstream file{path};
+  if (!file.is_open()) {
+    throw std::runtime_error("Couldn't open " + path);
+  }
+
+  std::vector<Aabb> bounds;
+  bool has_vertex = false;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.size() < 2) {
+      continue;
+    }
+    if (line[0] == 'o' && line[1] == ' ') {
+      has_vertex = false;
+    } else if (line[0] == 'v' && line[1] == ' ') {
+      std::istringstream stream{line.substr(2)};
+      glm::vec3 v;
+      stream >> v.x >> v.y >> v.z;
+      if (!has_vertex) {
+        bounds.push_back(Aabb{v, v});
+        has_vertex = true;
+      } else {
+        bounds.back().min = glm::min(bounds.back().min, v);
+        bounds.back().max = glm::max(bounds.back().max, v);
+      }
+    }
+  }
+
+  return bounds;
+}
+
+Aabb LoadObjBounds(const std::string& path) {
+  std::vector<Aabb> bounds = LoadObjObjectBounds(path);
+  if (bounds.empty()) {
+    throw std::runtime_error(path + " has no vertices");
+  }
+
+  Aabb result = bounds[0];
+  for (const Aabb& bb : bounds) {
+    result.min = glm::min(result.min, bb.min);
+    result.max = glm::max(result.max, bb.max);
+  }
+  return result;
+}
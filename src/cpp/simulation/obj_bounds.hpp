@@ -0,0 +1,24 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_OBJ_BOUNDS_HPP_
+#define SIMULATION_OBJ_BOUNDS_HPP_
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+struct Aabb {
+  glm::vec3 min, max;
+
+  glm::vec3 GetCenter() const { return (min + max) / 2.0f; }
+  glm::vec3 GetExtent() const { return max - min; }
+};
+
+// Returns the bounding box of every object ('o' statement) of an .obj file,
+// or of the whole file if it doesn't name its objects.
+std::vector<Aabb> LoadObjObjectBounds(const std::string& path);
+
+// The union of all the object bounds of an .obj file.
+Aabb LoadObjBounds(const std::string& path);
+
+#endif
@@ -0,0 +1,134 @@
+// Copyright (c) Tamas Csala
+
+#include "simulation/particle_simulation.hpp"
+#include "simulation/profiler.hpp"
+
+bool Particle::IsAlive(float current_time) const {
+  return born_at + lifespan > current_time;
+}
+
+void Particle::Update(float dt) {
+  pos += speed * dt;
+  speed += accel * dt;
+}
+
+Particle FireParticle(glm::vec3 startpos, float current_time, Random& random) {
+  Particle p;
+  p.born_at = current_time;
+  p.pos = startpos;
+
+  // Make the particles converge at (0, 4, 0)
+  p.accel = 0.5f*normalize(startpos + glm::vec3{0, 4, 0} - p.pos + 0.2f*random.RandomDir());
+  p.speed = 0.2f*random.RandomDir() + 4.0f*p.accel;
+
+  // 1 - 3 sec lifespan
+  p.lifespan = random.RandInt(20) / 10.0 + 1;
+
+  p.scale = 0.025 + 0.025*random.Rand01();
+  return p;
+}
+
+Particle ExplosionParticle(glm::vec3 startpos, float current_time, Random& random) {
+  Particle p;
+  p.born_at = current_time;
+  p.pos = startpos + random.RandomDir();
+  p.accel = (5.0f + 5.0f*random.Rand01())*normalize(random.RandomDir());
+  // p.accel.y = std::max(p.accel.y, 0.0f);
+  p.speed = 2.0f*p.accel;
+
+  // 0.5 - 1 sec lifespan
+  p.lifespan = random.RandInt(5) / 10.0 + 0.5;
+
+  p.scale = 0.1 + 0.1*random.Rand01();
+  return p;
+}
+
+ParticleRecord::ParticleRecord(const Particle& particle)
+    : pos_scale{particle.pos, particle.scale}
+    , speed_born_at{particle.speed, particle.born_at}
+    , accel_death_at{particle.accel, particle.born_at + particle.lifespan} {}
+
+ParticleSimulation::ParticleSimulation(ParticleGen generator, Random random,
+                                       int max_particles_at_once,
+                                       int max_particle_per_sec,
+                                       int max_particle_count)
+    : generator_{generator}
+    , random_{random}
+    , max_particles_at_once_{max_particles_at_once}
+    , max_particle_per_sec_{max_particle_per_sec}
+    , max_particle_count_{max_particle_count} {
+  records_.reserve(max_particles_at_once_);
+  is_spawned_.resize(max_particles_at_once_);
+}
+
+bool ParticleSimulation::CanSpawn() const {
+  return alive_count() < size_t(max_particles_at_once_) &&
+         (max_particle_count_ < 0 || particles_generated_ < max_particle_count_);
+}
+
+void ParticleSimulation::Spawn(const glm::vec3& emitter_pos, float current_time) {
+  ParticleRecord record{generator_(emitter_pos, current_time, random_)};
+
+  uint32_t slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+    records_[slot] = record;
+  } else {
+    slot = records_.size();
+    records_.push_back(record);
+  }
+  if (!is_spawned_[slot]) {
+    is_spawned_[slot] = true;
+    spawned_slots_.push_back(slot);
+  }
+  deaths_.push(Death{record.accel_death_at.w, slot});
+  particles_generated_++;
+}
+
+void ParticleSimulation::RemoveDeadParticles(float current_time) {
+  while (!deaths_.empty() && deaths_.top().first <= current_time) {
+    free_slots_.push_back(deaths_.top().second);
+    deaths_.pop();
+  }
+}
+
+void ParticleSimulation::ClearSpawnedSlots() {
+  for (uint32_t slot : spawned_slots_) {
+    is_spawned_[slot] = false;
+  }
+  spawned_slots_.clear();
+}
+
+void ParticleSimulation::Update(const glm::vec3& emitter_pos,
+                                float current_time, float dt) {
+  PYROMAZE_PROFILE_ZONE("ParticleSimulation::Update");
+  if (finished_) {
+    return;
+  }
+
+  newParticlesToSpawn_ += dt * max_particle_per_sec_;
+  RemoveDeadParticles(current_time);
+
+  if (max_particle_count_ >= particles_generated_ && alive_count() == 0) {
+    finished_ = true;
+    return;
+  }
+
+  while (newParticlesToSpawn_ >= 1 && CanSpawn()) {
+    Spawn(emitter_pos, current_time);
+    --newParticlesToSpawn_;
+  }
+}
+
+void ParticleSimulation::SpawnBurst(const glm::vec3& emitter_pos,
+                                    float current_time, int one_in) {
+  RemoveDeadParticles(current_time);
+
+  size_t dead_count = max_particles_at_once_ - alive_count();
+  for (size_t i = 0; i < dead_count; ++i) {
+    if (random_.RandInt(one_in) == 0 && particles_generated_ < max_particle_count_) {
+      Spawn(emitter_pos, current_time);
+    }
+  }
+}
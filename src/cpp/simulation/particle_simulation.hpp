@@ -0,0 +1,104 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_PARTICLE_SIMULATION_HPP_
+#define SIMULATION_PARTICLE_SIMULATION_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "simulation/random.hpp"
+
+struct Particle {
+  glm::vec3 pos, speed, accel;
+  float born_at = -1, lifespan = -1;
+  float scale = 0;
+
+  Particle() = default; // dead particle
+  bool IsAlive(float current_time) const;
+  void Update(float dt);
+};
+
+typedef Particle (*ParticleGen)(glm::vec3 startpos, float current_time, Random& random);
+
+Particle FireParticle(glm::vec3 startpos, float current_time, Random& random);
+Particle ExplosionParticle(glm::vec3 startpos, float current_time, Random& random);
+
+// A particle as it was spawned. Particle::Update only integrates a constant
+// acceleration, so the position is a closed form function of the age (see
+// GetPos, fire.vert does the same), and the record never changes while the
+// particle lives. The layout is the instance attributes of fire.vert.
+struct ParticleRecord {
+  glm::vec4 pos_scale;       // start position, scale
+  glm::vec4 speed_born_at;   // initial speed, time of the spawn
+  glm::vec4 accel_death_at;  // acceleration, time of the death
+
+  ParticleRecord() = default;
+  explicit ParticleRecord(const Particle& particle);
+
+  glm::vec3 GetPos(float current_time) const {
+    float age = current_time - speed_born_at.w;
+    return glm::vec3{pos_scale} + glm::vec3{speed_born_at} * age +
+           0.5f * glm::vec3{accel_death_at} * (age * age);
+  }
+  bool IsAlive(float current_time) const { return accel_death_at.w > current_time; }
+};
+
+// The CPU side of a particle effect: it only emits the spawn records, the
+// particles are never integrated. Every particle has a slot for its whole
+// life, the slots of the dead particles are reused through a free list, so
+// the records only have to be written (and uploaded) once.
+class ParticleSimulation {
+ public:
+  ParticleSimulation(ParticleGen generator, Random random,
+                     int max_particles_at_once, int max_particle_per_sec,
+                     int max_particle_count = -1);
+
+  void Update(const glm::vec3& emitter_pos, float current_time, float dt);
+
+  // Respawns each dead particle with 1/one_in probability (ignoring the
+  // per second limit) until max_particle_count is reached.
+  void SpawnBurst(const glm::vec3& emitter_pos, float current_time, int one_in);
+
+  // True once a limited emitter ran out of particles and all of them died.
+  bool IsFinished() const { return finished_; }
+
+  // The particles that were alive at the last Update, although some of them
+  // might have died since then.
+  size_t alive_count() const { return deaths_.size(); }
+  size_t max_particles_at_once() const { return max_particles_at_once_; }
+
+  // The slots that were ever used, the free ones hold dead particles.
+  size_t slot_count() const { return records_.size(); }
+  const ParticleRecord& record(size_t slot) const { return records_[slot]; }
+
+  // The slots written since the last ClearSpawnedSlots, each once.
+  const std::vector<uint32_t>& spawned_slots() const { return spawned_slots_; }
+  void ClearSpawnedSlots();
+
+ private:
+  // The death time and slot of a live particle, the earliest on the top
+  typedef std::pair<float, uint32_t> Death;
+
+  ParticleGen generator_;
+  Random random_;
+  float newParticlesToSpawn_ = 0.0;
+  int particles_generated_ = 0;
+  int max_particles_at_once_, max_particle_per_sec_, max_particle_count_;
+  bool finished_ = false;
+
+  std::vector<ParticleRecord> records_;
+  std::vector<uint32_t> free_slots_;
+  std::priority_queue<Death, std::vector<Death>, std::greater<Death>> deaths_;
+  std::vector<uint32_t> spawned_slots_;
+  std::vector<bool> is_spawned_;
+
+  bool CanSpawn() const;
+  void Spawn(const glm::vec3& emitter_pos, float current_time);
+  void RemoveDeadParticles(float current_time);
+};
+
+#endif
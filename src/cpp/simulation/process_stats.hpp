@@ -0,0 +1,12 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_PROCESS_STATS_HPP_
+#define SIMULATION_PROCESS_STATS_HPP_
+
+#include <cstddef>
+
+// The peak resident set size (working set on Windows) of the process in
+// bytes, or 0 if it isn't supported on the platform.
+size_t PeakResidentSetSize();
+
+#endif
@@ -0,0 +1,77 @@
+// Copyright (c) Tamas Csala
+
+#include <atomic>
+#include <fstream>
+
+#include "simulation/profiler.hpp"
+
+Profiler& Profiler::Get() {
+  static Profiler profiler;
+  return profiler;
+}
+
+Profiler::Profiler()
+    : epoch_(std::chrono::steady_clock::now())
+    , frames_(kDefaultFrameCount) {
+}
+
+int64_t Profiler::NowUs() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - epoch_).count();
+}
+
+uint32_t Profiler::ThreadIndex() {
+  static std::atomic<uint32_t> thread_count{0};
+  static thread_local uint32_t index = thread_count++;
+  return index;
+}
+
+void Profiler::BeginFrame() {
+  int64_t now = NowUs();
+  uint32_t thread = ThreadIndex();
+  std::lock_guard<std::mutex> lock{mutex_};
+  Frame& last_frame = frames_[current_frame_];
+  if (!last_frame.zones.empty()) {
+    last_frame.zones.push_back(Zone{"Frame", thread, last_frame.start_us, now});
+  }
+
+  current_frame_ = (current_frame_ + 1) % frames_.size();
+  Frame& frame = frames_[current_frame_];
+  frame.start_us = now;
+  // Keeps the capacity, so there are no allocations after the first cycle
+  frame.zones.clear();
+}
+
+void Profiler::AddZone(const char* name, int64_t start_us, int64_t end_us) {
+  uint32_t thread = ThreadIndex();
+  std::lock_guard<std::mutex> lock{mutex_};
+  frames_[current_frame_].zones.push_back(Zone{name, thread, start_us, end_us});
+}
+
+void Profiler::WriteChromeTrace(std::ostream& os) {
+  std::lock_guard<std::mutex> lock{mutex_};
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  for (size_t i = 1; i <= frames_.size(); ++i) {
+    const Frame& frame = frames_[(current_frame_ + i) % frames_.size()];
+    if (frame.zones.empty()) {
+      continue;
+    }
+    for (const Zone& zone : frame.zones) {
+      os << (first ? "\n" : ",\n")
+         << "{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << zone.thread
+         << ",\"ts\":" << zone.start_us << ",\"dur\":" << zone.end_us - zone.start_us << "}";
+      first = false;
+    }
+  }
+  os << "\n]}" << std::endl;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) {
+  std::ofstream file{path.c_str()};
+  if (!file) {
+    return false;
+  }
+  WriteChromeTrace(file);
+  return file.good();
+}
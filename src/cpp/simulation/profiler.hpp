@@ -0,0 +1,92 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_PROFILER_HPP_
+#define SIMULATION_PROFILER_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// The zones are only recorded if the game is built with PYROMAZE_PROFILER,
+// otherwise the macros expand to nothing.
+#ifdef PYROMAZE_PROFILER
+  #define PYROMAZE_PROFILE_CONCAT_IMPL(a, b) a##b
+  #define PYROMAZE_PROFILE_CONCAT(a, b) PYROMAZE_PROFILE_CONCAT_IMPL(a, b)
+  // Times the rest of the enclosing scope. The name must be a string literal.
+  #define PYROMAZE_PROFILE_ZONE(name) \
+    ProfileZone PYROMAZE_PROFILE_CONCAT(profile_zone_, __LINE__){name}
+  // Should be called once per frame, before its first zone.
+  #define PYROMAZE_PROFILE_FRAME() Profiler::Get().BeginFrame()
+#else
+  #define PYROMAZE_PROFILE_ZONE(name) do {} while (false)
+  #define PYROMAZE_PROFILE_FRAME() do {} while (false)
+#endif
+
+// Keeps the timing zones of the last frames in a ring buffer, and writes
+// them in the Chrome trace event format (chrome://tracing, Perfetto).
+// Zones can be recorded from any thread.
+class Profiler {
+ public:
+#ifdef PYROMAZE_PROFILER
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+  static constexpr size_t kDefaultFrameCount = 300;
+
+  static Profiler& Get();
+
+  void BeginFrame();
+  void AddZone(const char* name, int64_t start_us, int64_t end_us);
+  int64_t NowUs() const;
+
+  // Writes the zones of the frames in the buffer, the oldest first.
+  void WriteChromeTrace(std::ostream& os);
+  // Returns false if the file can't be written.
+  bool WriteChromeTrace(const std::string& path);
+
+  // Where the trace is written by the hotkey (F3) and at exit.
+  const std::string& trace_path() const { return trace_path_; }
+  void set_trace_path(const std::string& path) { trace_path_ = path; }
+
+ private:
+  struct Zone {
+    const char* name;
+    uint32_t thread;
+    int64_t start_us, end_us;
+  };
+
+  struct Frame {
+    int64_t start_us = 0;
+    std::vector<Zone> zones;
+  };
+
+  std::chrono::steady_clock::time_point epoch_;
+  std::mutex mutex_;
+  // Empty frames aren't written
+  std::vector<Frame> frames_;
+  size_t current_frame_ = 0;
+  std::string trace_path_ = "pyromaze_trace.json";
+
+  Profiler();
+  static uint32_t ThreadIndex();
+};
+
+class ProfileZone {
+ public:
+  explicit ProfileZone(const char* name)
+      : name_(name), start_us_(Profiler::Get().NowUs()) {}
+  ~ProfileZone() {
+    Profiler& profiler = Profiler::Get();
+    profiler.AddZone(name_, start_us_, profiler.NowUs());
+  }
+
+ private:
+  const char* name_;
+  int64_t start_us_;
+};
+
+#endif
@@ -0,0 +1,107 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_RANDOM_HPP_
+#define SIMULATION_RANDOM_HPP_
+
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// A small and fast random generator (PCG32). Unlike rand(), every instance
+// has its own state, so independent subsystems don't disturb each other,
+// and instances can be used from different threads.
+class Random {
+ public:
+  explicit Random(uint64_t seed = 0, uint64_t stream = 0)
+      : state_(0), increment_((stream << 1u) | 1u) {
+    NextUInt();
+    state_ += seed;
+    NextUInt();
+  }
+
+  uint32_t NextUInt() {
+    uint64_t old_state = state_;
+    state_ = old_state * 6364136223846793005ULL + increment_;
+    uint32_t xorshifted = uint32_t(((old_state >> 18u) ^ old_state) >> 27u);
+    uint32_t rot = uint32_t(old_state >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+  }
+
+  // Uniform in [0, 1)
+  float Rand01() {
+    return (NextUInt() >> 8) * (1.0f / 16777216.0f);
+  }
+
+  // Uniform in [0, n)
+  int RandInt(int n) {
+    return int((uint64_t(NextUInt()) * uint64_t(n)) >> 32);
+  }
+
+  // Uniformly distributed unit vector
+  glm::vec3 RandomDir() {
+    float z = 2.0f*Rand01() - 1.0f;
+    float phi = 6.28318530718f*Rand01();
+    float r = std::sqrt(std::max(1.0f - z*z, 0.0f));
+    return glm::vec3{r*std::cos(phi), r*std::sin(phi), z};
+  }
+
+  // A new generator, independent from this one.
+  Random Fork() {
+    uint64_t seed = (uint64_t(NextUInt()) << 32) | NextUInt();
+    uint64_t stream = (uint64_t(NextUInt()) << 32) | NextUInt();
+    return Random{seed, stream};
+  }
+
+ private:
+  uint64_t state_, increment_;
+};
+
+enum class RandomStream : uint64_t {
+  kLabyrinth, kGameplay, kParticles, kLights
+};
+
+// Named random streams derived from one scene seed. Using separate streams
+// makes, for example, the labyrinth layout independent of how many
+// particles were spawned before it was generated.
+class RandomStreams {
+ public:
+  explicit RandomStreams(uint64_t seed)
+      : seed_(seed)
+      , streams_{ForStream(seed, 0), ForStream(seed, 1),
+                 ForStream(seed, 2), ForStream(seed, 3)} {}
+
+  uint64_t seed() const { return seed_; }
+
+  Random& Get(RandomStream stream) {
+    return streams_[static_cast<size_t>(stream)];
+  }
+
+  // A generator that only depends on the seed, the stream and a grid cell,
+  // so content generated per cell doesn't depend on the generation order.
+  Random ForCell(RandomStream stream, int x, int z) const {
+    uint64_t cell = (uint64_t(uint32_t(x)) << 32) | uint64_t(uint32_t(z));
+    return Random{Mix(seed_ ^ Mix(cell)), static_cast<uint64_t>(stream)};
+  }
+
+ private:
+  uint64_t seed_;
+  Random streams_[4];
+
+  // PCG streams that only differ in their increment are correlated, so every
+  // stream starts from its own state too. The seed is mixed once more than in
+  // ForCell, so a stream doesn't coincide with any of its cells.
+  static Random ForStream(uint64_t seed, uint64_t stream) {
+    return Random{Mix(Mix(seed) ^ Mix(stream + 1)), stream};
+  }
+
+  // splitmix64 finalizer
+  static uint64_t Mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+};
+
+#endif
@@ -0,0 +1,118 @@
+// Copyright (c) Tamas Csala
+
+#include <utility>
+
+#include "simulation/robot_swarm.hpp"
+#include "simulation/game_rules.hpp"
+#include "simulation/profiler.hpp"
+
+RobotState* RobotSwarm::Add(std::unique_ptr<RobotState> robot) {
+  RobotState* added = robot.get();
+  added->index_ = robots_.size();
+  added->cell = grid_.GetCell(added->GetPos());
+  added->body->forceActivationState(DISABLE_SIMULATION);
+  grid_.Insert(added, added->cell);
+  robots_.push_back(std::move(robot));
+  if (GameRules::IsInRobotActivationRange(player_cell_, added->cell)) {
+    WakeUp(added);
+  }
+  return added;
+}
+
+std::unique_ptr<RobotState> RobotSwarm::Remove(RobotState* robot) {
+  if (!robot->dormant) {
+    RemoveFromAwakeRobots(robot);
+  }
+  grid_.Remove(robot, robot->cell);
+
+  size_t index = robot->index_;
+  std::swap(robots_[index], robots_.back());
+  robots_[index]->index_ = index;
+  std::unique_ptr<RobotState> removed = std::move(robots_.back());
+  robots_.pop_back();
+  return removed;
+}
+
+void RobotSwarm::SetPlayerPos(const glm::dvec3& player_pos) {
+  GridCell player_cell = grid_.GetCell(player_pos);
+  if (player_cell != player_cell_) {
+    player_cell_ = player_cell;
+    GameRules::ForEachInRobotActivationRange(grid_, player_cell_, [this](RobotState* robot) {
+      WakeUp(robot);
+    });
+  }
+}
+
+void RobotSwarm::WakeUp(RobotState* robot) {
+  if (!robot->dormant) {
+    return;
+  }
+  robot->dormant = false;
+  robot->awake_index_ = awake_robots_.size();
+  awake_robots_.push_back(robot);
+  robot->body->forceActivationState(ACTIVE_TAG);
+  robot->body->activate();
+}
+
+void RobotSwarm::PutToSleep(RobotState* robot) {
+  RemoveFromAwakeRobots(robot);
+  robot->body->setLinearVelocity({0, 0, 0});
+  robot->body->forceActivationState(DISABLE_SIMULATION);
+}
+
+void RobotSwarm::RemoveFromAwakeRobots(RobotState* robot) {
+  robot->dormant = true;
+  awake_robots_[robot->awake_index_] = awake_robots_.back();
+  awake_robots_[robot->awake_index_]->awake_index_ = robot->awake_index_;
+  awake_robots_.pop_back();
+}
+
+void RobotSwarm::Update(const glm::dvec3& player_pos, const FlowField& flow_field,
+                        double current_time, DetonationQueue* detonations,
+                        std::vector<RobotState*>* exploded) {
+  PYROMAZE_PROFILE_ZONE("RobotSwarm::Update");
+  for (size_t i = 0; i < awake_robots_.size();) {
+    RobotState* robot = awake_robots_[i];
+    btRigidBody* body = robot->body;
+    glm::dvec3 robot_pos = robot->GetPos();
+    GridCell cell = grid_.GetCell(robot_pos);
+    grid_.Move(robot, robot->cell, cell);
+    robot->cell = cell;
+
+    if (GameRules::kRobotExplodes && robot->activation_time > 0 &&
+        current_time - robot->activation_time > GameRules::kRobotTimeToExplode) {
+      detonations->Push(robot_pos);
+      exploded->push_back(robot);
+      ++i;
+      continue;
+    }
+
+    glm::dvec3 velocity;
+    if (!GameRules::RobotChaseVelocity(robot_pos, player_pos, flow_field, &velocity)) {
+      if (!GameRules::IsInRobotActivationRange(player_cell_, robot->cell)) {
+        // Swaps the next awake robot to i
+        PutToSleep(robot);
+        continue;
+      }
+      body->setLinearVelocity({0, 0, 0});
+      body->setActivationState(WANTS_DEACTIVATION);
+      ++i;
+      continue;
+    }
+
+    body->activate();
+    if (robot->activation_time < 0) {
+      robot->activation_time = current_time;
+    }
+    body->setLinearVelocity(btVector3(velocity.x, velocity.y, velocity.z));
+    ++i;
+  }
+}
+
+void RobotSwarm::FindRobotsHit(const Blast& blast, std::vector<RobotState*>* hits) const {
+  grid_.Query(blast.center, blast.QueryRadius(), [&](RobotState* robot) {
+    if (blast.HitsActor(robot->GetPos())) {
+      hits->push_back(robot);
+    }
+  });
+}
@@ -0,0 +1,85 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_ROBOT_SWARM_HPP_
+#define SIMULATION_ROBOT_SWARM_HPP_
+
+#include <memory>
+#include <vector>
+#include <btBulletDynamicsCommon.h>
+
+#include "simulation/detonation_queue.hpp"
+#include "simulation/flow_field.hpp"
+#include "simulation/spatial_grid.hpp"
+
+// The game logic of a robot. Its rigid body belongs to whoever shows the
+// robot (the Robot scene object, or the headless simulation), the swarm only
+// sets its velocity and activation.
+struct RobotState {
+  btRigidBody* body = nullptr;
+  // Where the labyrinth generated the robot, the grid records its death there.
+  GridCell spawn_junction;
+  GridCell cell;
+  double activation_time = -1.0;
+  bool dormant = true;
+
+  glm::dvec3 GetPos() const {
+    const btVector3& pos = body->getWorldTransform().getOrigin();
+    return glm::dvec3(pos.x(), pos.y(), pos.z());
+  }
+
+ private:
+  size_t index_ = 0, awake_index_ = 0;
+  friend class RobotSwarm;
+};
+
+// The robots of the loaded chunks, bucketed by labyrinth cell. The ones
+// around the player are woken up whenever the player enters a new cell, the
+// robots that are far from the player go dormant, and aren't updated (or
+// simulated by the physics) at all.
+class RobotSwarm {
+ public:
+  RobotSwarm() : grid_(kWallLength) {}
+
+  size_t size() const { return robots_.size(); }
+  size_t awake_count() const { return awake_robots_.size(); }
+  GridCell player_cell() const { return player_cell_; }
+
+  // The robot's body must be set, it is woken up if it's near the player.
+  RobotState* Add(std::unique_ptr<RobotState> robot);
+  // The robot's body isn't touched, so it can be destroyed after this.
+  std::unique_ptr<RobotState> Remove(RobotState* robot);
+
+  // Wakes up the robots around the player, if it entered a new cell.
+  void SetPlayerPos(const glm::dvec3& player_pos);
+
+  // Chases the player with the awake robots, and puts the ones that lost it
+  // far from the player to sleep. The robots that blew themselves up (see
+  // GameRules::kRobotExplodes) are appended to exploded, they should be
+  // removed by the caller.
+  void Update(const glm::dvec3& player_pos, const FlowField& flow_field, double current_time,
+              DetonationQueue* detonations, std::vector<RobotState*>* exploded);
+
+  // Appends the robots that the blast hits, they should be removed by the
+  // caller.
+  void FindRobotsHit(const Blast& blast, std::vector<RobotState*>* hits) const;
+
+  template<typename Visitor>
+  void ForEach(Visitor visitor) const {
+    for (const std::unique_ptr<RobotState>& robot : robots_) {
+      visitor(robot.get());
+    }
+  }
+
+ private:
+  std::vector<std::unique_ptr<RobotState>> robots_;
+  // Only these are updated
+  std::vector<RobotState*> awake_robots_;
+  SpatialGrid<RobotState> grid_;
+  GridCell player_cell_;
+
+  void WakeUp(RobotState* robot);
+  void PutToSleep(RobotState* robot);
+  void RemoveFromAwakeRobots(RobotState* robot);
+};
+
+#endif
@@ -0,0 +1,127 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_SPATIAL_GRID_HPP_
+#define SIMULATION_SPATIAL_GRID_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+struct GridCell {
+  int x = 0, z = 0;
+
+  GridCell() = default;
+  GridCell(int x, int z) : x(x), z(z) {}
+
+  bool operator==(const GridCell& other) const { return x == other.x && z == other.z; }
+  bool operator!=(const GridCell& other) const { return !(*this == other); }
+};
+
+// A uniform grid on the xz plane, that stores object pointers by cell.
+// The cells are centered at the integer multiples of the cell size, so with
+// kWallLength spacing a cell is a labyrinth cell. The grid doesn't own the
+// objects, they have to remove themselves before they die.
+template<typename T>
+class SpatialGrid {
+ public:
+  explicit SpatialGrid(double cell_size) : cell_size_(cell_size) {}
+
+  double cell_size() const { return cell_size_; }
+  size_t size() const { return size_; }
+
+  GridCell GetCell(const glm::dvec3& pos) const {
+    return GridCell(static_cast<int>(std::floor(pos.x / cell_size_ + 0.5)),
+                    static_cast<int>(std::floor(pos.z / cell_size_ + 0.5)));
+  }
+
+  void Insert(T* object, GridCell cell) {
+    cells_[Key(cell)].push_back(object);
+    size_++;
+  }
+
+  void Remove(T* object, GridCell cell) {
+    auto iter = cells_.find(Key(cell));
+    if (iter == cells_.end()) {
+      return;
+    }
+    std::vector<T*>& objects = iter->second;
+    auto obj_iter = std::find(objects.begin(), objects.end(), object);
+    if (obj_iter != objects.end()) {
+      *obj_iter = objects.back();
+      objects.pop_back();
+      size_--;
+    }
+    if (objects.empty()) {
+      cells_.erase(iter);
+    }
+  }
+
+  void Move(T* object, GridCell from, GridCell to) {
+    if (from != to) {
+      Remove(object, from);
+      Insert(object, to);
+    }
+  }
+
+  // Calls visitor(T*) for every object in a cell that intersects the circle
+  // (on the xz plane) of the given center and radius.
+  template<typename Visitor>
+  void Query(const glm::dvec3& center, double radius, Visitor visitor) const {
+    GridCell min = GetCell(glm::dvec3(center.x - radius, 0, center.z - radius));
+    GridCell max = GetCell(glm::dvec3(center.x + radius, 0, center.z + radius));
+    for (int x = min.x; x <= max.x; ++x) {
+      for (int z = min.z; z <= max.z; ++z) {
+        if (!IntersectsCircle(GridCell(x, z), center, radius)) {
+          continue;
+        }
+        auto iter = cells_.find(Key(GridCell(x, z)));
+        if (iter != cells_.end()) {
+          for (T* object : iter->second) {
+            visitor(object);
+          }
+        }
+      }
+    }
+  }
+
+  // Calls visitor(T*) for every object of the given cell.
+  template<typename Visitor>
+  void ForEachInCell(GridCell cell, Visitor visitor) const {
+    auto iter = cells_.find(Key(cell));
+    if (iter != cells_.end()) {
+      for (T* object : iter->second) {
+        visitor(object);
+      }
+    }
+  }
+
+  template<typename Visitor>
+  void ForEach(Visitor visitor) const {
+    for (const auto& cell : cells_) {
+      for (T* object : cell.second) {
+        visitor(object);
+      }
+    }
+  }
+
+ private:
+  double cell_size_;
+  size_t size_ = 0;
+  std::unordered_map<uint64_t, std::vector<T*>> cells_;
+
+  static uint64_t Key(GridCell cell) {
+    return (uint64_t(uint32_t(cell.x)) << 32) | uint64_t(uint32_t(cell.z));
+  }
+
+  bool IntersectsCircle(GridCell cell, const glm::dvec3& center, double radius) const {
+    double half_size = cell_size_ / 2;
+    double dx = std::max(std::abs(center.x - cell.x * cell_size_) - half_size, 0.0);
+    double dz = std::max(std::abs(center.z - cell.z * cell_size_) - half_size, 0.0);
+    return dx*dx + dz*dz <= radius*radius;
+  }
+};
+
+#endif
@@ -0,0 +1,174 @@
+// Copyright (c) Tamas Csala
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "simulation/texture_cache.hpp"
+
+static const char kTextureCacheMagic[8] = {'P', 'Y', 'R', 'O', 'T', 'E', 'X', '\0'};
+static const uint32_t kTextureCacheVersion = 1;
+
+std::vector<RgbaImage> SplitCubeCross(const RgbaImage& cross) {
+  if (cross.width % 4 != 0 || cross.width / 4 != cross.height / 3) {
+    throw std::runtime_error("The cubemap isn't a horizontal cross");
+  }
+  unsigned size = cross.width / 4;
+
+  // The top left corner of the faces, in face sizes
+  static const unsigned kFaceOrigins[6][2] = {
+    {2, 1}, {0, 1}, {1, 0}, {1, 2}, {1, 1}, {3, 1}
+  };
+
+  std::vector<RgbaImage> faces(6);
+  for (int i = 0; i < 6; ++i) {
+    RgbaImage& face = faces[i];
+    face.width = face.height = size;
+    face.rgba.resize(4*size*size);
+    unsigned startx = kFaceOrigins[i][0] * size, starty = kFaceOrigins[i][1] * size;
+    for (unsigned y = 0; y < size; ++y) {
+      std::memcpy(&face.rgba[4*y*size], &cross.rgba[4*((starty + y)*cross.width + startx)], 4*size);
+    }
+  }
+  return faces;
+}
+
+static float SrgbToLinear(unsigned char value) {
+  float c = value / 255.0f;
+  return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static unsigned char LinearToSrgb(float c) {
+  c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+  return static_cast<unsigned char>(std::min(std::max(c, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+std::vector<RgbaImage> BuildMipChain(const RgbaImage& image) {
+  float to_linear[256];
+  for (int i = 0; i < 256; ++i) {
+    to_linear[i] = SrgbToLinear(i);
+  }
+
+  std::vector<RgbaImage> levels{image};
+  while (levels.back().width > 1 || levels.back().height > 1) {
+    const RgbaImage& src = levels.back();
+    RgbaImage dst;
+    dst.width = std::max(src.width / 2, 1u);
+    dst.height = std::max(src.height / 2, 1u);
+    dst.rgba.resize(4*dst.width*dst.height);
+    for (unsigned y = 0; y < dst.height; ++y) {
+      for (unsigned x = 0; x < dst.width; ++x) {
+        // The odd last row / column of the source is clamped
+        unsigned x0 = std::min(2*x, src.width - 1), x1 = std::min(2*x + 1, src.width - 1);
+        unsigned y0 = std::min(2*y, src.height - 1), y1 = std::min(2*y + 1, src.height - 1);
+        const unsigned char* texels[4] = {
+          &src.rgba[4*(y0*src.width + x0)], &src.rgba[4*(y0*src.width + x1)],
+          &src.rgba[4*(y1*src.width + x0)], &src.rgba[4*(y1*src.width + x1)]
+        };
+        unsigned char* out = &dst.rgba[4*(y*dst.width + x)];
+        for (int c = 0; c < 3; ++c) {
+          float sum = 0;
+          for (const unsigned char* texel : texels) {
+            sum += to_linear[texel[c]];
+          }
+          out[c] = LinearToSrgb(sum / 4);
+        }
+        unsigned alpha = 0;
+        for (const unsigned char* texel : texels) {
+          alpha += texel[3];
+        }
+        out[3] = (alpha + 2) / 4;
+      }
+    }
+    levels.push_back(std::move(dst));
+  }
+  return levels;
+}
+
+std::string TextureCachePath(const std::string& png_path) {
+  return png_path + ".texcache";
+}
+
+bool WriteTextureCache(const std::string& png_path,
+                       const std::vector<std::vector<RgbaImage>>& faces) {
+  assert(!faces.empty() && !faces[0].empty());
+  TextureCacheHeader header = {};
+  std::memcpy(header.magic, kTextureCacheMagic, sizeof(header.magic));
+  header.version = kTextureCacheVersion;
+  header.face_count = faces.size();
+  header.level_count = faces[0].size();
+  header.width = faces[0][0].width;
+  header.height = faces[0][0].height;
+  if (!header.source.Read(png_path)) {
+    return false;
+  }
+
+  std::vector<TextureCacheLevel> levels;
+  uint64_t offset = sizeof(TextureCacheHeader) +
+                    header.face_count * header.level_count * sizeof(TextureCacheLevel);
+  for (uint32_t face = 0; face < header.face_count; ++face) {
+    assert(faces[face].size() == header.level_count);
+    for (uint32_t level = 0; level < header.level_count; ++level) {
+      const RgbaImage& image = faces[face][level];
+      TextureCacheLevel entry = {face, level, image.width, image.height,
+                                 offset, image.rgba.size()};
+      levels.push_back(entry);
+      offset += entry.size;
+    }
+  }
+
+  std::ofstream file{TextureCachePath(png_path), std::ios::binary | std::ios::trunc};
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(levels.data()),
+             levels.size() * sizeof(TextureCacheLevel));
+  for (const std::vector<RgbaImage>& face : faces) {
+    for (const RgbaImage& image : face) {
+      file.write(reinterpret_cast<const char*>(image.rgba.data()), image.rgba.size());
+    }
+  }
+  return file.good();
+}
+
+std::unique_ptr<MappedTextureCache> MappedTextureCache::Open(const std::string& png_path) {
+  std::unique_ptr<MappedTextureCache> cache{new MappedTextureCache{}};
+  if (!cache->file_.Open(TextureCachePath(png_path)) ||
+      cache->file_.size() < sizeof(TextureCacheHeader)) {
+    return nullptr;
+  }
+
+  const TextureCacheHeader& header = cache->header();
+  FileStamp source;
+  if (std::memcmp(header.magic, kTextureCacheMagic, sizeof(header.magic)) != 0 ||
+      header.version != kTextureCacheVersion ||
+      (header.face_count != 1 && header.face_count != 6) || header.level_count == 0 ||
+      !source.Read(png_path) || header.source != source) {
+    return nullptr;
+  }
+
+  uint64_t table_end = sizeof(TextureCacheHeader) +
+                       uint64_t{header.face_count} * header.level_count * sizeof(TextureCacheLevel);
+  if (cache->file_.size() < table_end) {
+    return nullptr;
+  }
+  for (uint32_t face = 0; face < header.face_count; ++face) {
+    for (uint32_t level = 0; level < header.level_count; ++level) {
+      const TextureCacheLevel& entry = cache->level(face, level);
+      if (entry.face != face || entry.level != level ||
+          entry.size != uint64_t{4} * entry.width * entry.height ||
+          entry.offset < table_end || entry.offset + entry.size > cache->file_.size()) {
+        return nullptr;
+      }
+    }
+  }
+
+  return cache;
+}
+
+const TextureCacheLevel& MappedTextureCache::level(unsigned face, unsigned level) const {
+  const TextureCacheLevel* levels = reinterpret_cast<const TextureCacheLevel*>(
+      file_.data() + sizeof(TextureCacheHeader));
+  return levels[face * header().level_count + level];
+}
@@ -0,0 +1,79 @@
+// Copyright (c) Tamas Csala
+
+#ifndef SIMULATION_TEXTURE_CACHE_HPP_
+#define SIMULATION_TEXTURE_CACHE_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulation/mapped_file.hpp"
+
+// A preprocessed version of a .png, written by the pyromaze_texture_cache tool
+// next to the .png (path + ".texcache"). The faces of a cubemap are already
+// cut out of the cross layout, and every face has a full mip chain, so the
+// texels can be uploaded straight from the mapped file. The layout is:
+//   TextureCacheHeader
+//   TextureCacheLevel[face_count * level_count]    face major
+//   RGBA8 texels of the levels, at their offsets
+// Everything is 4 byte aligned, in the byte order of the machine that wrote it.
+
+struct TextureCacheHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t face_count;  // 1, or 6 for a cubemap
+  uint32_t level_count;
+  uint32_t width, height;  // of level 0
+  // The .png that the cache was made from, a different one makes it stale
+  FileStamp source;
+};
+
+struct TextureCacheLevel {
+  uint32_t face, level;
+  uint32_t width, height;
+  // Of the texels, from the start of the file
+  uint64_t offset, size;
+};
+
+struct RgbaImage {
+  unsigned width = 0, height = 0;
+  std::vector<unsigned char> rgba;
+};
+
+// The six faces of a horizontal cross layout, in the order of the
+// GL_TEXTURE_CUBE_MAP_POSITIVE_X + i targets.
+std::vector<RgbaImage> SplitCubeCross(const RgbaImage& cross);
+
+// The image and its 2x2 box filtered halvings down to 1x1. The colors are
+// sRGB, they are averaged in linear space.
+std::vector<RgbaImage> BuildMipChain(const RgbaImage& image);
+
+std::string TextureCachePath(const std::string& png_path);
+
+// faces[face][level], every face must have the same mip chain. Returns false
+// if the .png can't be read or the cache can't be written.
+bool WriteTextureCache(const std::string& png_path,
+                       const std::vector<std::vector<RgbaImage>>& faces);
+
+// A read-only memory mapping of a texture cache file.
+class MappedTextureCache {
+ public:
+  // Returns nullptr if the cache doesn't exist, or it's stale or corrupt.
+  static std::unique_ptr<MappedTextureCache> Open(const std::string& png_path);
+
+  const TextureCacheHeader& header() const {
+    return *reinterpret_cast<const TextureCacheHeader*>(file_.data());
+  }
+  const TextureCacheLevel& level(unsigned face, unsigned level) const;
+  const unsigned char* texels(const TextureCacheLevel& level) const {
+    return file_.data() + level.offset;
+  }
+
+ private:
+  MappedFile file_;
+
+  MappedTextureCache() = default;
+};
+
+#endif
@@ -7,9 +7,10 @@ layout(location = 1) in vec2 aTexCoord;
 layout(location = 2) in vec3 aNormal;
 layout(location = 3) in vec3 aTangent;
 layout(location = 4) in mat4 aModelMatrix;
+// The burning end of this dynamite's fuse, in model space
+layout(location = 8) in vec3 aFirePos;
 
 uniform mat4 uProjectionMatrix, uCameraMatrix;
-uniform vec3 uFirePos;
 
 out vec3 w_vPos;
 out vec3 w_vNormal;
@@ -20,10 +21,11 @@ void main() {
   mat3 normalMatrix = inverse(mat3(aModelMatrix));
   w_vNormal = aNormal * normalMatrix;
   w_vTangent = aTangent * normalMatrix;
-  vTexCoord = aTexCoord;
+  // The .obj's v axis points up, the rows of the uploaded png go down
+  vTexCoord = vec2(aTexCoord.x, 1 - aTexCoord.y);
 
-  bool fuse_already_burnt = aPosition.x > uFirePos.x && aPosition.y > 1.15;
-  vec4 m_pos = fuse_already_burnt ? vec4(uFirePos, 1) : aPosition;
+  bool fuse_already_burnt = aPosition.x > aFirePos.x && aPosition.y > 1.15;
+  vec4 m_pos = fuse_already_burnt ? vec4(aFirePos, 1) : aPosition;
   w_vPos = vec3(aModelMatrix * m_pos);
 
   gl_Position = uProjectionMatrix * uCameraMatrix * aModelMatrix * m_pos;
@@ -5,13 +5,29 @@
 in vec3 aPosition;
 in vec3 aNormal;
 
+// per particle spawn records, see ParticleRecord
+in vec4 aStartPosScale;
+in vec4 aSpeedBornAt;
+in vec4 aAccelDeathAt;
+
 uniform mat4 uCameraMatrix;
 uniform mat4 uProjectionMatrix;
-uniform mat4 uModelMatrix;
+uniform float uCurrentTime;
 
 out vec3 vNormal;
+out float vLifeTime;
 
 void main() {
   vNormal = aNormal;
-  gl_Position = uProjectionMatrix * (uCameraMatrix * (uModelMatrix * vec4(aPosition, 1)));
+  vLifeTime = uCurrentTime - aSpeedBornAt.w;
+  if (uCurrentTime >= aAccelDeathAt.w) {
+    // A dead particle in a free slot, behind the far plane
+    gl_Position = vec4(0, 0, 2, 1);
+    return;
+  }
+
+  float age = vLifeTime;
+  vec3 pos = aStartPosScale.xyz + aSpeedBornAt.xyz * age + 0.5 * aAccelDeathAt.xyz * (age * age);
+  vec3 w_pos = pos + aStartPosScale.w * aPosition;
+  gl_Position = uProjectionMatrix * (uCameraMatrix * vec4(w_pos, 1));
 }
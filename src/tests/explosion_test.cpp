@@ -0,0 +1,370 @@
+// Copyright (c) Tamas Csala
+
+// Checks that GameWorld, which resolves a blast once (when it detonates),
+// destroys the same things as the explosions did when they re-tested their
+// surroundings on every frame of their first half second. Every object is
+// static here, which is where the two agree: an actor that walks into the
+// blast after the detonation frame is no longer hit, a later check shows it.
+//
+// Should be run from the repository root (the collision reads the meshes),
+// returns non-zero if any of the checks fail.
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "simulation/game_rules.hpp"
+#include "simulation/game_world.hpp"
+
+namespace {
+
+constexpr int kRadius = 12;
+// The frames of the half second that an explosion used to damage for
+constexpr int kLegacyDamageFrames = 30;
+constexpr int kScenarioCount = 16;
+
+int failure_count = 0;
+
+void Check(bool condition, int seed, const char* what) {
+  if (!condition) {
+    std::printf("FAILED (seed %d): %s\n", seed, what);
+    failure_count++;
+  }
+}
+
+glm::dvec3 RandomPos(Random& random, double extent) {
+  return glm::dvec3{(2*random.Rand01() - 1) * extent, 0, (2*random.Rand01() - 1) * extent};
+}
+
+// Keeps what the world shows, the robots get bodies without a physics world.
+class TestListener : public GameWorldListener {
+ public:
+  std::unordered_set<const RobotState*> robots;
+  std::unordered_set<const DynamiteState*> dynamites;
+  int blast_count = 0, player_hit_count = 0, border_wall_hit_count = 0;
+
+  virtual void OnChunkLoaded(LabyrinthChunkCoord chunk, const LabyrinthChunkWalls& walls,
+                             std::unique_ptr<btCompoundShape> collision_shape) override {
+    shapes_[chunk.Key()] = std::move(collision_shape);
+  }
+  virtual void OnChunkWallsReset(LabyrinthChunkCoord, const LabyrinthChunkWalls&) override {}
+  virtual void OnWallPartsRemoved(LabyrinthChunkCoord, const std::vector<WallPartHit>&) override {}
+  virtual void OnChunkUnloaded(LabyrinthChunkCoord chunk) override {
+    shapes_.erase(chunk.Key());
+  }
+
+  virtual btRigidBody* OnRobotAdded(RobotState* robot, const glm::dvec3& pos) override {
+    btRigidBody::btRigidBodyConstructionInfo info{1.0f, nullptr, &robot_shape_, btVector3(0, 0, 0)};
+    info.m_startWorldTransform.setIdentity();
+    info.m_startWorldTransform.setOrigin(btVector3(pos.x, pos.y, pos.z));
+    std::unique_ptr<btRigidBody> body{new btRigidBody(info)};
+    btRigidBody* added = body.get();
+    bodies_[robot] = std::move(body);
+    robots.insert(robot);
+    return added;
+  }
+  virtual void OnRobotRemoved(RobotState* robot) override {
+    robots.erase(robot);
+    bodies_.erase(robot);
+  }
+
+  virtual void OnDynamiteAdded(DynamiteState* dynamite) override { dynamites.insert(dynamite); }
+  virtual void OnDynamiteRemoved(DynamiteState* dynamite) override { dynamites.erase(dynamite); }
+
+  virtual void OnBlast(const Blast&) override { blast_count++; }
+  virtual void OnPlayerHit() override { player_hit_count++; }
+  virtual void OnBorderWallHit() override { border_wall_hit_count++; }
+
+ private:
+  btSphereShape robot_shape_{1.0};
+  std::unordered_map<uint64_t, std::unique_ptr<btCompoundShape>> shapes_;
+  std::unordered_map<const RobotState*, std::unique_ptr<btRigidBody>> bodies_;
+};
+
+// The resolution before the one-shot one, on a snapshot of the world: each
+// explosion tested every standing wall part, actor and border wall on every
+// frame of its first half second, by brute force, and the dynamites (and
+// robots, see kRobotExplodes) that it hit exploded on the next frame.
+class LegacyWorld {
+ public:
+  LegacyWorld(const GameWorld& world, const TestListener& listener, const glm::dvec3& player_pos)
+      : player_pos_(player_pos) {
+    for (int x = -kRadius; x <= kRadius; ++x) {
+      for (int z = -kRadius; z <= kRadius; ++z) {
+        walls_.push_back(world.grid().GetWallParts(x, z));
+      }
+    }
+    for (const RobotState* robot : listener.robots) {
+      robots_.push_back(Actor{robot, robot->GetPos()});
+    }
+    for (const DynamiteState* dynamite : listener.dynamites) {
+      dynamites_.push_back(Actor{dynamite, dynamite->pos});
+    }
+  }
+
+  void Run(const LabyrinthCollision& collision, std::vector<glm::dvec3> detonations) {
+    struct Explosion {
+      glm::dvec3 pos;
+      int frames_left;
+    };
+    std::vector<Explosion> explosions;
+    while (!explosions.empty() || !detonations.empty()) {
+      for (const glm::dvec3& pos : detonations) {
+        explosions.push_back(Explosion{pos, kLegacyDamageFrames});
+      }
+      detonations.clear();
+
+      for (size_t i = 0; i < explosions.size();) {
+        Damage(collision, explosions[i].pos, &detonations);
+        if (--explosions[i].frames_left == 0) {
+          explosions[i] = explosions.back();
+          explosions.pop_back();
+          continue;
+        }
+        ++i;
+      }
+    }
+  }
+
+  uint8_t GetWallParts(int x, int z) const {
+    return walls_[(x + kRadius) * (2*kRadius + 1) + (z + kRadius)];
+  }
+
+  bool IsAlive(const void* actor) const {
+    for (const std::vector<Actor>* actors : {&robots_, &dynamites_}) {
+      for (const Actor& a : *actors) {
+        if (a.id == actor) {
+          return a.alive;
+        }
+      }
+    }
+    return false;
+  }
+
+  bool player_hit() const { return player_hit_; }
+  bool border_wall_hit() const { return border_wall_hit_; }
+
+ private:
+  struct Actor {
+    const void* id;
+    glm::dvec3 pos;
+    bool alive = true;
+
+    Actor(const void* id, const glm::dvec3& pos) : id(id), pos(pos) {}
+  };
+
+  glm::dvec3 player_pos_;
+  std::vector<uint8_t> walls_;
+  std::vector<Actor> robots_, dynamites_;
+  bool player_hit_ = false, border_wall_hit_ = false;
+
+  void Damage(const LabyrinthCollision& collision, const glm::dvec3& pos,
+              std::vector<glm::dvec3>* detonations) {
+    const double radius = GameRules::kExplosionRadius;
+    for (int x = -kRadius; x <= kRadius; ++x) {
+      for (int z = -kRadius; z <= kRadius; ++z) {
+        uint8_t& parts = walls_[(x + kRadius) * (2*kRadius + 1) + (z + kRadius)];
+        glm::vec3 junction_pos = LabyrinthGrid::GetJunctionPos(x, z);
+        for (int i = 0; i < 4; ++i) {
+          glm::dvec3 part_center = glm::dvec3(junction_pos + collision.GetWallPartCenter(i));
+          if (((parts >> i) & 1) && GameRules::IsWallPartHit(pos, radius, part_center)) {
+            parts &= ~(1 << i);
+          }
+        }
+      }
+    }
+
+    for (Actor& robot : robots_) {
+      if (robot.alive && GameRules::IsActorHit(pos, radius, robot.pos)) {
+        robot.alive = false;
+        if (GameRules::kRobotExplodes) {
+          detonations->push_back(robot.pos);
+        }
+      }
+    }
+    for (Actor& dynamite : dynamites_) {
+      if (dynamite.alive && GameRules::IsActorHit(pos, radius, dynamite.pos)) {
+        dynamite.alive = false;
+        detonations->push_back(dynamite.pos);
+      }
+    }
+    if (GameRules::IsActorHit(pos, radius, player_pos_)) {
+      player_hit_ = true;
+    }
+
+    const int border = kRadius + 1;
+    for (int x = -border; x <= border; ++x) {
+      for (int z = -border; z <= border; ++z) {
+        if ((std::abs(x) == border || std::abs(z) == border) &&
+            GameRules::IsBorderWallHit(pos, radius, glm::dvec3(LabyrinthGrid::GetJunctionPos(x, z)))) {
+          border_wall_hit_ = true;
+        }
+      }
+    }
+  }
+};
+
+// Resolves the detonations and the chain reactions that they set off. The
+// time doesn't advance, so the fuses don't burn down meanwhile.
+void ResolveAll(GameWorld* world, const glm::dvec3& player_pos) {
+  do {
+    world->Update(0.0, player_pos);
+  } while (!world->detonations()->empty());
+}
+
+void CheckSameDestruction(const LabyrinthCollision& collision, int seed) {
+  Random random{uint64_t(seed)};
+  glm::dvec3 player_pos = RandomPos(random, 4 * kWallLength) + glm::dvec3{0, 3, 0};
+  TestListener listener;
+  GameWorld world{uint64_t(seed), kRadius, player_pos, false, &listener};
+
+  const double extent = kRadius * kWallLength;
+  for (int i = 0; i < 64; ++i) {
+    world.AddDynamite(RandomPos(random, extent));
+  }
+  // A field close enough to chain
+  glm::dvec3 field = RandomPos(random, extent / 2);
+  for (int i = 0; i < 16; ++i) {
+    world.AddDynamite(field + glm::dvec3{(i % 4) * 8.0, 0, (i / 4) * 8.0});
+  }
+
+  std::vector<glm::dvec3> detonations;
+  for (int i = 0; i < 8; ++i) {
+    detonations.push_back(RandomPos(random, extent));
+  }
+  detonations.push_back(field);
+  for (const RobotState* robot : listener.robots) {
+    if (random.RandInt(8) == 0) {
+      detonations.push_back(robot->GetPos() * glm::dvec3{1, 0, 1});
+    }
+  }
+  if (seed % 3 != 0) {
+    detonations.push_back(glm::dvec3{(kRadius + 1) * kWallLength - 5, 0, RandomPos(random, extent).z});
+  }
+  if (seed % 2 == 0) {
+    detonations.push_back(player_pos * glm::dvec3{1, 0, 1});
+  }
+
+  LegacyWorld legacy{world, listener, player_pos};
+  legacy.Run(collision, detonations);
+
+  std::vector<const RobotState*> robots{listener.robots.begin(), listener.robots.end()};
+  std::vector<const DynamiteState*> dynamites{listener.dynamites.begin(), listener.dynamites.end()};
+  for (const glm::dvec3& pos : detonations) {
+    world.detonations()->Push(pos);
+  }
+  ResolveAll(&world, player_pos);
+
+  bool same_walls = true;
+  for (int x = -kRadius; x <= kRadius; ++x) {
+    for (int z = -kRadius; z <= kRadius; ++z) {
+      same_walls = same_walls && world.grid().GetWallParts(x, z) == legacy.GetWallParts(x, z);
+    }
+  }
+  Check(same_walls, seed, "the same wall parts are destroyed");
+
+  size_t robots_killed = 0, dynamites_set_off = 0;
+  bool same_robots = true, same_dynamites = true;
+  for (const RobotState* robot : robots) {
+    bool alive = listener.robots.count(robot);
+    same_robots = same_robots && alive == legacy.IsAlive(robot);
+    robots_killed += !alive;
+  }
+  for (const DynamiteState* dynamite : dynamites) {
+    bool alive = listener.dynamites.count(dynamite);
+    same_dynamites = same_dynamites && alive == legacy.IsAlive(dynamite);
+    dynamites_set_off += !alive;
+  }
+  Check(same_robots, seed, "the same robots are killed");
+  Check(same_dynamites, seed, "the same dynamites are set off");
+  Check((listener.player_hit_count > 0) == legacy.player_hit(), seed,
+        "the player is hit the same way");
+  Check((listener.border_wall_hit_count > 0) == legacy.border_wall_hit(), seed,
+        "a border wall is hit the same way");
+
+  std::printf("seed %2d: %zu wall parts, %zu/%zu robots, %zu/%zu dynamites, player %s, "
+              "border wall %s\n", seed, world.grid().destroyed_wall_part_count(),
+              robots_killed, robots.size(), dynamites_set_off, dynamites.size(),
+              listener.player_hit_count > 0 ? "hit" : "missed",
+              listener.border_wall_hit_count > 0 ? "hit" : "missed");
+}
+
+// The behaviour change of the one-shot resolution: the blast is over after
+// its detonation frame, a robot that arrives later survives it (the per-frame
+// resolution killed it during the half second).
+void CheckLateArrivalIsNotHit() {
+  const int seed = 1;
+  TestListener listener;
+  GameWorld world{uint64_t(seed), kRadius, glm::dvec3{0, 3, 0}, false, &listener};
+  Check(!listener.robots.empty(), seed, "the labyrinth has robots");
+  if (listener.robots.empty()) {
+    return;
+  }
+
+  const RobotState* robot = *listener.robots.begin();
+  glm::dvec3 robot_pos = robot->GetPos();
+  // Wakes the robot up, only the awake robots are moved in the grid
+  world.Update(0.0, robot_pos);
+  glm::dvec3 away = robot_pos.x > 0 ? glm::dvec3{-1, 0, 0} : glm::dvec3{1, 0, 0};
+  glm::dvec3 blast_pos = robot_pos * glm::dvec3{1, 0, 1} +
+                         away * (1.2*GameRules::kExplosionRadius + kWallLength);
+
+  world.detonations()->Push(blast_pos);
+  world.Update(0.0, robot_pos);
+  Check(listener.robots.count(robot) == 1, seed, "a robot out of the blast survives it");
+
+  robot->body->getWorldTransform().setOrigin(btVector3(blast_pos.x, robot_pos.y, blast_pos.z));
+  for (int frame = 0; frame < kLegacyDamageFrames; ++frame) {
+    world.Update(0.0, robot_pos);
+  }
+  Check(listener.robots.count(robot) == 1, seed,
+        "a robot that walks into the blast after the detonation isn't hit");
+}
+
+// Blasts of the same frame that don't overlap can each hit the player and the
+// border walls, the game still ends only once.
+void CheckEndIsReportedOnce() {
+  const int seed = 2;
+  const double offset = 1.1 * GameRules::kExplosionRadius;
+  const double border = (kRadius + 1) * kWallLength;
+  TestListener listener;
+  GameWorld world{uint64_t(seed), kRadius, glm::dvec3{0, 3, 0}, false, &listener};
+
+  world.detonations()->Push(glm::dvec3{-offset, 0, 0});
+  world.detonations()->Push(glm::dvec3{offset, 0, 0});
+  world.detonations()->Push(glm::dvec3{border - 3, 0, -offset});
+  world.detonations()->Push(glm::dvec3{border - 3, 0, offset});
+  world.Update(0.0, glm::dvec3{0, 3, 0});
+  Check(listener.blast_count == 4, seed, "the detonations are separate blasts");
+  Check(listener.player_hit_count == 1, seed, "the player hit is reported once");
+  Check(listener.border_wall_hit_count == 1, seed, "the border wall hit is reported once");
+}
+
+}
+
+int main() {
+  std::unique_ptr<LabyrinthCollision> collision;
+  try {
+    collision.reset(new LabyrinthCollision{});
+  } catch (const std::exception& e) {
+    std::printf("explosion_test: %s (should be run from the repository root)\n", e.what());
+    return EXIT_FAILURE;
+  }
+
+  for (int seed = 1; seed <= kScenarioCount; ++seed) {
+    CheckSameDestruction(*collision, seed);
+  }
+  CheckLateArrivalIsNotHit();
+  CheckEndIsReportedOnce();
+
+  if (failure_count > 0) {
+    std::printf("%d checks failed\n", failure_count);
+    return EXIT_FAILURE;
+  }
+  std::printf("All checks passed\n");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,35 @@
+// Copyright (c) Tamas Csala
+
+// Converts .obj files to the binary mesh cache format, see
+// simulation/mesh_cache.hpp. Usage: pyromaze_mesh_cache <file.obj>...
+
+#include <exception>
+#include <iostream>
+
+#include "simulation/mesh_cache.hpp"
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file.obj>..." << std::endl;
+    return 1;
+  }
+
+  int failures = 0;
+  for (int i = 1; i < argc; ++i) {
+    try {
+      ObjMesh mesh = ParseObjMesh(argv[i]);
+      if (!WriteMeshCache(argv[i], mesh)) {
+        std::cerr << "Can't write " << MeshCachePath(argv[i]) << std::endl;
+        failures++;
+        continue;
+      }
+      std::cout << MeshCachePath(argv[i]) << ": " << mesh.object_bounds.size() << " objects, "
+                << mesh.vertices.size() << " vertices, " << mesh.indices.size() / 3
+                << " triangles" << std::endl;
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      failures++;
+    }
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+// Copyright (c) Tamas Csala
+
+// Converts .png files to the preprocessed texture cache format, see
+// simulation/texture_cache.hpp. The cubemaps (horizontal cross layout) must
+// be preceded by --cube. Usage: pyromaze_texture_cache [--cube] <file.png>...
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <lodepng.h>
+
+#include "simulation/texture_cache.hpp"
+
+static RgbaImage DecodePng(const std::string& path) {
+  RgbaImage image;
+  unsigned error = lodepng::decode(image.rgba, image.width, image.height, path, LCT_RGBA, 8);
+  if (error) {
+    throw std::runtime_error(path + ": " + lodepng_error_text(error));
+  }
+  return image;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " [--cube] <file.png>..." << std::endl;
+    return 1;
+  }
+
+  int failures = 0;
+  bool cube = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], "--cube") == 0) {
+      cube = true;
+      continue;
+    }
+
+    try {
+      RgbaImage image = DecodePng(argv[i]);
+      std::vector<std::vector<RgbaImage>> faces;
+      if (cube) {
+        for (const RgbaImage& face : SplitCubeCross(image)) {
+          faces.push_back(BuildMipChain(face));
+        }
+      } else {
+        faces.push_back(BuildMipChain(image));
+      }
+      if (!WriteTextureCache(argv[i], faces)) {
+        std::cerr << "Can't write " << TextureCachePath(argv[i]) << std::endl;
+        failures++;
+      } else {
+        std::cout << TextureCachePath(argv[i]) << ": " << faces.size() << " x "
+                  << faces[0][0].width << "x" << faces[0][0].height << ", "
+                  << faces[0].size() << " levels" << std::endl;
+      }
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      failures++;
+    }
+    cube = false;
+  }
+  return failures == 0 ? 0 : 1;
+}